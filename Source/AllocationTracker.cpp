@@ -0,0 +1,216 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "AllocationTracker.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace TSOCA
+{
+    namespace
+    {
+        struct ScopeCounters
+        {
+            std::atomic<int64_t> liveBytes{};
+            std::atomic<int64_t> peakBytes{};
+            std::atomic<uint64_t> allocations{};
+            std::atomic<uint64_t> currentFrameAllocations{};
+            std::atomic<uint64_t> frameAllocations{};
+        };
+
+        ScopeCounters gCounters[ALLOCATION_SCOPES_COUNT]{};
+        thread_local AllocationScope gScope{GENERAL_SCOPE};
+    } // namespace
+
+    namespace AllocationTracker
+    {
+        AllocationCounters GetCounters(AllocationScope scope)
+        {
+            const auto& counters = gCounters[scope];
+            return {counters.liveBytes.load(std::memory_order_relaxed), counters.peakBytes.load(std::memory_order_relaxed),
+                    counters.allocations.load(std::memory_order_relaxed), counters.frameAllocations.load(std::memory_order_relaxed)};
+        }
+
+        uint64_t GetCurrentFrameAllocations()
+        {
+            uint64_t allocations{};
+            for (const auto& counters : gCounters)
+                allocations += counters.currentFrameAllocations.load(std::memory_order_relaxed);
+            return allocations;
+        }
+
+        void EndFrame()
+        {
+            for (auto& counters : gCounters)
+                counters.frameAllocations = counters.currentFrameAllocations.exchange(0, std::memory_order_relaxed);
+        }
+
+        const char* GetScopeName(AllocationScope scope)
+        {
+            switch (scope)
+            {
+            case GENERAL_SCOPE: return "General";
+            case SCRIPTS_SCOPE: return "Scripts";
+            case VN_SCOPE: return "VN";
+            case WORLD_SCOPE: return "World";
+            case GUI_SCOPE: return "GUI";
+            case AUDIO_SCOPE: return "Audio";
+            case ALLOCATION_SCOPES_COUNT: break;
+            }
+            return "";
+        }
+
+        AllocationScope GetScope()
+        {
+            return gScope;
+        }
+
+        void SetScope(AllocationScope scope)
+        {
+            gScope = scope;
+        }
+    } // namespace AllocationTracker
+} // namespace TSOCA
+
+#ifdef TSOCA_TRACK_ALLOCATIONS
+namespace
+{
+    using namespace TSOCA;
+
+    // Stored right before every tracked block, so any form of delete can find its size, scope and the malloc'd pointer.
+    struct alignas(16) AllocationHeader
+    {
+        uint64_t size;
+        uint32_t offset;
+        AllocationScope scope;
+    };
+
+    void* TrackedAllocate(size_t size, size_t alignment) noexcept
+    {
+        alignment = alignment < alignof(AllocationHeader) ? alignof(AllocationHeader) : alignment;
+        // malloc only guarantees alignof(std::max_align_t), which may be less than the header's 16 bytes.
+        auto* raw = static_cast<std::byte*>(std::malloc(size + sizeof(AllocationHeader) + alignment - 1));
+        if (!raw)
+            return nullptr;
+        auto address = reinterpret_cast<uintptr_t>(raw + sizeof(AllocationHeader));
+        address = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        auto* ptr = reinterpret_cast<std::byte*>(address);
+
+        const auto scope = gScope;
+        auto* header = reinterpret_cast<AllocationHeader*>(ptr) - 1;
+        header->size = size;
+        header->offset = static_cast<uint32_t>(ptr - raw);
+        header->scope = scope;
+
+        auto& counters = gCounters[scope];
+        const auto live = counters.liveBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+        auto peak = counters.peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+        {
+        }
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.currentFrameAllocations.fetch_add(1, std::memory_order_relaxed);
+        return ptr;
+    }
+
+    void TrackedFree(void* ptr) noexcept
+    {
+        if (!ptr)
+            return;
+        const auto* header = static_cast<AllocationHeader*>(ptr) - 1;
+        gCounters[header->scope].liveBytes.fetch_sub(static_cast<int64_t>(header->size), std::memory_order_relaxed);
+        std::free(static_cast<std::byte*>(ptr) - header->offset);
+    }
+
+    void* TrackedNew(size_t size, size_t alignment)
+    {
+        if (auto* ptr = TrackedAllocate(size ? size : 1, alignment))
+            return ptr;
+        throw std::bad_alloc{};
+    }
+} // namespace
+
+void* operator new(size_t size)
+{
+    return TrackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size)
+{
+    return TrackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return TrackedNew(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return TrackedNew(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return TrackedAllocate(size ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return TrackedAllocate(size ? size : 1, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    TrackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    TrackedFree(ptr);
+}
+#endif
@@ -0,0 +1,77 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace TSOCA
+{
+    enum AllocationScope : uint8_t
+    {
+        GENERAL_SCOPE,
+        SCRIPTS_SCOPE,
+        VN_SCOPE,
+        WORLD_SCOPE,
+        GUI_SCOPE,
+        AUDIO_SCOPE,
+        ALLOCATION_SCOPES_COUNT
+    };
+
+    struct AllocationCounters
+    {
+        int64_t liveBytes{};
+        int64_t peakBytes{};
+        uint64_t allocations{};
+        // Allocations made during the last finished frame.
+        uint64_t frameAllocations{};
+    };
+
+    // Hooks global operator new/delete when built with -DTSOCA_TRACK_ALLOCATIONS=ON,
+    // otherwise every function is a no-op and the counters stay zero.
+    namespace AllocationTracker
+    {
+#ifdef TSOCA_TRACK_ALLOCATIONS
+        constexpr bool IS_ENABLED{true};
+#else
+        constexpr bool IS_ENABLED{false};
+#endif
+
+        AllocationCounters GetCounters(AllocationScope scope);
+        // Allocations made so far in the current frame, across all scopes.
+        uint64_t GetCurrentFrameAllocations();
+        void EndFrame();
+        const char* GetScopeName(AllocationScope scope);
+
+        AllocationScope GetScope();
+        void SetScope(AllocationScope scope);
+    } // namespace AllocationTracker
+
+    // Tags allocations made on this thread until the guard goes out of scope.
+    class AllocationScopeGuard
+    {
+      public:
+        explicit AllocationScopeGuard(AllocationScope scope)
+        {
+            if constexpr (AllocationTracker::IS_ENABLED)
+            {
+                mPrevScope = AllocationTracker::GetScope();
+                AllocationTracker::SetScope(scope);
+            }
+        }
+
+        ~AllocationScopeGuard()
+        {
+            if constexpr (AllocationTracker::IS_ENABLED)
+                AllocationTracker::SetScope(mPrevScope);
+        }
+
+        AllocationScopeGuard(const AllocationScopeGuard&) = delete;
+        AllocationScopeGuard& operator=(const AllocationScopeGuard&) = delete;
+
+      private:
+        AllocationScope mPrevScope{};
+    };
+} // namespace TSOCA
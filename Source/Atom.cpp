@@ -0,0 +1,103 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Atom.hpp"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace TSOCA
+{
+    namespace
+    {
+        class AtomTable
+        {
+          public:
+            AtomTable()
+            {
+                mStrings.emplace_back();
+                mIds.emplace(mStrings.back(), 0);
+            }
+
+            uint32_t Intern(std::string_view text)
+            {
+                {
+                    std::shared_lock lock{mMutex};
+                    if (const auto it = mIds.find(text); it != mIds.end())
+                        return it->second;
+                }
+                std::unique_lock lock{mMutex};
+                if (const auto it = mIds.find(text); it != mIds.end())
+                    return it->second;
+                // std::deque never moves its elements, so the views used as keys stay valid.
+                const auto id = static_cast<uint32_t>(mStrings.size());
+                mStrings.emplace_back(text);
+                mMemoryUsage += text.size() + sizeof(std::string);
+                mIds.emplace(mStrings.back(), id);
+                return id;
+            }
+
+            std::string_view Get(uint32_t id) const
+            {
+                std::shared_lock lock{mMutex};
+                return id < mStrings.size() ? std::string_view{mStrings[id]} : std::string_view{};
+            }
+
+            size_t GetCount() const
+            {
+                std::shared_lock lock{mMutex};
+                return mStrings.size();
+            }
+
+            size_t GetMemoryUsage() const
+            {
+                std::shared_lock lock{mMutex};
+                return mMemoryUsage + mIds.size() * (sizeof(std::string_view) + sizeof(uint32_t) + 2 * sizeof(void*));
+            }
+
+          private:
+            mutable std::shared_mutex mMutex{};
+            std::deque<std::string> mStrings{};
+            std::unordered_map<std::string_view, uint32_t> mIds{};
+            size_t mMemoryUsage{};
+        };
+
+        AtomTable& GetTable()
+        {
+            static AtomTable table{};
+            return table;
+        }
+    } // namespace
+
+    Atom::Atom(std::string_view text) : mId(GetTable().Intern(text))
+    {
+    }
+
+    size_t Atom::GetCount()
+    {
+        return GetTable().GetCount();
+    }
+
+    size_t Atom::GetMemoryUsage()
+    {
+        return GetTable().GetMemoryUsage();
+    }
+
+    std::string_view Atom::GetString() const
+    {
+        return GetTable().Get(mId);
+    }
+
+    namespace Atoms
+    {
+        const Atom& Start()
+        {
+            static const Atom atom{"start"};
+            return atom;
+        }
+    } // namespace Atoms
+} // namespace TSOCA
@@ -0,0 +1,54 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace TSOCA
+{
+    // Interned string: equal text always maps to the same 32-bit id, so comparison and hashing are O(1).
+    // Atoms live for the whole run; the table is safe to use from worker threads.
+    class Atom
+    {
+      public:
+        constexpr Atom() = default;
+        explicit Atom(std::string_view text);
+
+        static size_t GetCount();
+        static size_t GetMemoryUsage();
+
+        [[nodiscard]] std::string_view GetString() const;
+        [[nodiscard]] constexpr uint32_t GetId() const
+        {
+            return mId;
+        }
+        [[nodiscard]] constexpr bool IsEmpty() const
+        {
+            return mId == 0;
+        }
+
+        constexpr bool operator==(const Atom&) const = default;
+
+      private:
+        uint32_t mId{};
+    };
+
+    namespace Atoms
+    {
+        const Atom& Start();
+    } // namespace Atoms
+} // namespace TSOCA
+
+template <>
+struct std::hash<TSOCA::Atom>
+{
+    size_t operator()(const TSOCA::Atom& atom) const noexcept
+    {
+        return atom.GetId();
+    }
+};
@@ -0,0 +1,171 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "AutosaveJournal.hpp"
+#include "TextUtils.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace TSOCA
+{
+    AutosaveJournal::AutosaveJournal(std::filesystem::path journalPath, std::filesystem::path checkpointPath, uint32_t capacity,
+                                     uint32_t compactInterval)
+        : mJournalPath(std::move(journalPath)), mCheckpointPath(std::move(checkpointPath)), mCapacity(capacity),
+          mCompactInterval(std::min(compactInterval, capacity))
+    {
+    }
+
+    bool AutosaveJournal::Open(bool keepCheckpoint)
+    {
+        CompactSave save{};
+        if (!keepCheckpoint)
+            std::filesystem::remove(mCheckpointPath);
+        else if (Recover(save))
+            WriteCompactSave(mCheckpointPath, save);
+
+        if (!mFile.OpenWritable(mJournalPath, sizeof(Header) + sizeof(Record) * mCapacity))
+            return false;
+
+        auto* header = GetHeader();
+        if (header->magic != MAGIC || header->version != VERSION)
+            *header = {MAGIC, VERSION, 0, 0};
+        // Records of older generations fail the checksum, so the journal never needs clearing.
+        mIsCompacting = false;
+        StartGeneration(0);
+        return true;
+    }
+
+    void AutosaveJournal::Close()
+    {
+        mFile.Flush();
+        mFile.Close();
+        mCount = 0;
+        mIsCompacting = false;
+    }
+
+    void AutosaveJournal::Append(const CompactSave& save)
+    {
+        // Full only when a checkpoint write takes longer than capacity - compactInterval steps.
+        if (!mFile.IsOpen() || mCount >= mCapacity)
+            return;
+
+        Record record{save.iterator, save.anchorHash, save.anchorOffset};
+        record.checksum = CalculateChecksum(record, GetHeader()->generation);
+        std::memcpy(GetRecords() + mCount++, &record, sizeof(Record));
+        mLastSave = save;
+    }
+
+    bool AutosaveJournal::IsCompactDue() const
+    {
+        return mFile.IsOpen() && !mIsCompacting && mCount >= mCompactInterval;
+    }
+
+    CompactSave AutosaveJournal::BeginCompact()
+    {
+        mIsCompacting = true;
+        mCompactCount = mCount;
+        mCompactGeneration = GetGeneration();
+        return mLastSave;
+    }
+
+    void AutosaveJournal::EndCompact(bool isWritten)
+    {
+        if (!mIsCompacting || GetGeneration() != mCompactGeneration)
+            return;
+        mIsCompacting = false;
+        if (isWritten)
+            StartGeneration(mCount - mCompactCount);
+    }
+
+    void AutosaveJournal::Compact(const CompactSave& save)
+    {
+        if (!mFile.IsOpen() || !WriteCompactSave(mCheckpointPath, save))
+            return;
+        mIsCompacting = false;
+        StartGeneration(0);
+        mFile.Flush();
+    }
+
+    bool AutosaveJournal::Recover(CompactSave& save) const
+    {
+        bool isRecovered = ReadCompactSave(mCheckpointPath, save);
+
+        MappedFile file{};
+        if (!file.Open(mJournalPath) || file.GetSize() < sizeof(Header))
+            return isRecovered;
+
+        Header header{};
+        std::memcpy(&header, file.GetData(), sizeof(Header));
+        if (header.magic != MAGIC || header.version != VERSION)
+            return isRecovered;
+
+        const auto count = (file.GetSize() - sizeof(Header)) / sizeof(Record);
+        const auto* records = file.GetData() + sizeof(Header);
+        for (size_t i{}; i < count; ++i)
+        {
+            Record record{};
+            std::memcpy(&record, records + i * sizeof(Record), sizeof(Record));
+            if (record.checksum != CalculateChecksum(record, header.generation))
+                break;
+            save.iterator = record.iterator;
+            save.anchorHash = record.anchorHash;
+            save.anchorOffset = record.anchorOffset;
+            isRecovered = true;
+        }
+        return isRecovered;
+    }
+
+    bool AutosaveJournal::IsExists() const
+    {
+        CompactSave save{};
+        return Recover(save);
+    }
+
+    uint32_t AutosaveJournal::GetCount() const
+    {
+        return mCount;
+    }
+
+    uint32_t AutosaveJournal::GetGeneration() const
+    {
+        return mFile.IsOpen() ? reinterpret_cast<const Header*>(mFile.GetData())->generation : 0;
+    }
+
+    const std::filesystem::path& AutosaveJournal::GetCheckpointPath() const
+    {
+        return mCheckpointPath;
+    }
+
+    uint32_t AutosaveJournal::CalculateChecksum(const Record& record, uint32_t generation)
+    {
+        const uint32_t data[]{generation, record.iterator, record.anchorHash, record.anchorOffset};
+        return HashString({reinterpret_cast<const char*>(data), sizeof(data)}) | 1u;
+    }
+
+    AutosaveJournal::Header* AutosaveJournal::GetHeader()
+    {
+        return reinterpret_cast<Header*>(mFile.GetMutableData());
+    }
+
+    AutosaveJournal::Record* AutosaveJournal::GetRecords()
+    {
+        return reinterpret_cast<Record*>(mFile.GetMutableData() + sizeof(Header));
+    }
+
+    void AutosaveJournal::StartGeneration(uint32_t keptRecords)
+    {
+        // The last `keptRecords` records are newer than the checkpoint, so they move to the new generation.
+        const auto generation = ++GetHeader()->generation;
+        auto* records = GetRecords();
+        for (uint32_t i{}; i < keptRecords; ++i)
+        {
+            Record record{};
+            std::memcpy(&record, records + mCount - keptRecords + i, sizeof(Record));
+            record.checksum = CalculateChecksum(record, generation);
+            std::memcpy(records + i, &record, sizeof(Record));
+        }
+        mCount = keptRecords;
+    }
+} // namespace TSOCA
@@ -0,0 +1,82 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "CompactSave.hpp"
+#include "MappedFile.hpp"
+#include <filesystem>
+
+namespace TSOCA
+{
+    // Appends one fixed-size record per step into a memory-mapped journal, so a step costs a
+    // memcpy and survives a crash of the process. Every `compactInterval` records the latest
+    // position is written into a checkpoint save (by the caller, off the main thread) and the
+    // journal starts a new generation.
+    class AutosaveJournal
+    {
+      public:
+        AutosaveJournal(std::filesystem::path journalPath, std::filesystem::path checkpointPath, uint32_t capacity = 1024,
+                        uint32_t compactInterval = 256);
+
+        // Starts a new generation; `keepCheckpoint` is false when a new game begins.
+        bool Open(bool keepCheckpoint);
+        void Close();
+
+        void Append(const CompactSave& save);
+        [[nodiscard]] bool IsCompactDue() const;
+        // Returns the position to write into the checkpoint; records appended until EndCompact() are kept.
+        [[nodiscard]] CompactSave BeginCompact();
+        // Starts the new generation once the checkpoint is on disk; ignored if the journal was reopened meanwhile.
+        void EndCompact(bool isWritten);
+        // Writes the checkpoint on the calling thread, e.g. on shutdown.
+        void Compact(const CompactSave& save);
+
+        // Returns the latest position from the checkpoint and the valid journal tail.
+        [[nodiscard]] bool Recover(CompactSave& save) const;
+        [[nodiscard]] bool IsExists() const;
+
+        [[nodiscard]] uint32_t GetCount() const;
+        [[nodiscard]] uint32_t GetGeneration() const;
+        [[nodiscard]] const std::filesystem::path& GetCheckpointPath() const;
+
+      private:
+        struct Header
+        {
+            uint32_t magic{};
+            uint32_t version{};
+            uint32_t generation{};
+            uint32_t reserved{};
+        };
+
+        struct Record
+        {
+            uint32_t iterator{};
+            uint32_t anchorHash{};
+            uint32_t anchorOffset{};
+            uint32_t checksum{};
+        };
+
+        static constexpr uint32_t MAGIC{0x4E4A5354}; // "TSJN"
+        static constexpr uint32_t VERSION{1};
+
+        static uint32_t CalculateChecksum(const Record& record, uint32_t generation);
+        Header* GetHeader();
+        Record* GetRecords();
+        void StartGeneration(uint32_t keptRecords);
+
+        std::filesystem::path mJournalPath{};
+        std::filesystem::path mCheckpointPath{};
+        MappedFile mFile{};
+        CompactSave mLastSave{};
+        uint32_t mCapacity{};
+        uint32_t mCompactInterval{};
+        uint32_t mCount{};
+        // Records covered by the checkpoint being written, and the generation they belong to.
+        uint32_t mCompactCount{};
+        uint32_t mCompactGeneration{};
+        bool mIsCompacting{};
+    };
+} // namespace TSOCA
@@ -0,0 +1,289 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Benchmark.hpp"
+#include "AllocationTracker.hpp"
+#include "FrameCapture.hpp"
+#include "Oneiro/Renderer/OpenGL/Texture.hpp"
+#include "Oneiro/Runtime/Engine.hpp"
+#include "yaml-cpp/yaml.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace TSOCA
+{
+    namespace
+    {
+        constexpr uint32_t GPU_QUERIES_COUNT{4};
+        constexpr uint32_t MAX_STALLED_STEPS{16};
+
+        uint64_t HashPixels(const std::vector<uint8_t>& pixels)
+        {
+            uint64_t hash{14695981039346656037ull};
+            for (const uint8_t byte : pixels)
+            {
+                hash ^= byte;
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        std::string ToHex(uint64_t value)
+        {
+            std::ostringstream stream{};
+            stream << std::hex << value;
+            return stream.str();
+        }
+    } // namespace
+
+    Benchmark::Benchmark(BenchmarkOptions options) : mOptions(std::move(options))
+    {
+        mQueries.resize(GPU_QUERIES_COUNT);
+        gl::GenQueries(GPU_QUERIES_COUNT, mQueries.data());
+    }
+
+    Benchmark::~Benchmark()
+    {
+        gl::DeleteQueries(static_cast<int>(mQueries.size()), mQueries.data());
+    }
+
+    bool Benchmark::LoadReference()
+    {
+        if (mOptions.reference.empty())
+            return true;
+        if (!std::filesystem::exists(mOptions.reference))
+        {
+            OE_LOG_WARNING("Benchmark reference '" + mOptions.reference.string() + "' does not exist!");
+            return false;
+        }
+
+        // yaml-cpp reports malformed files only by throwing.
+        YAML::Node checkpoints{};
+        try
+        {
+            checkpoints = YAML::LoadFile(mOptions.reference.string())["Benchmark"]["Checkpoints"];
+        }
+        catch (const YAML::Exception&)
+        {
+        }
+        if (!checkpoints.IsMap() || !checkpoints.size())
+        {
+            OE_LOG_WARNING("Benchmark reference '" + mOptions.reference.string() + "' has no checkpoints!");
+            return false;
+        }
+
+        for (const auto& checkpoint : checkpoints)
+        {
+            const auto iterator = checkpoint.first.Scalar();
+            const auto hash = checkpoint.second.Scalar();
+            uint32_t parsedIterator{};
+            uint64_t parsedHash{};
+            const auto iteratorResult = std::from_chars(iterator.data(), iterator.data() + iterator.size(), parsedIterator);
+            const auto hashResult = std::from_chars(hash.data(), hash.data() + hash.size(), parsedHash, 16);
+            if (iteratorResult.ec != std::errc{} || iteratorResult.ptr != iterator.data() + iterator.size() ||
+                hashResult.ec != std::errc{} || hashResult.ptr != hash.data() + hash.size())
+            {
+                OE_LOG_WARNING("Benchmark reference '" + mOptions.reference.string() + "' has an invalid checkpoint '" + iterator + "'!");
+                return false;
+            }
+            mReferenceHashes[parsedIterator] = parsedHash;
+        }
+        return true;
+    }
+
+    float Benchmark::BeginFrame()
+    {
+        mPrevFrameBegin = mFrameBegin;
+        mFrameBegin = std::chrono::steady_clock::now();
+        if (mFrame)
+            mFrameIntervals.push_back(std::chrono::duration<double, std::milli>(mFrameBegin - mPrevFrameBegin).count());
+
+        ReadGpuTimestamps();
+        gl::QueryCounter(mQueries[mFrame % GPU_QUERIES_COUNT], gl::TIMESTAMP);
+        mFrame++;
+        return mOptions.deltaTime;
+    }
+
+    bool Benchmark::Update(uint32_t currentIt, bool isBlocked)
+    {
+        mTimeSinceStep += mOptions.deltaTime;
+
+        const bool isCheckpoint = mNextCheckpoint < mOptions.checkpoints.size() && currentIt >= mOptions.checkpoints[mNextCheckpoint];
+        if (isCheckpoint)
+        {
+            if (mTimeSinceStep < mOptions.settleTime)
+                return false;
+            CaptureCheckpoint(currentIt);
+            while (mNextCheckpoint < mOptions.checkpoints.size() && currentIt >= mOptions.checkpoints[mNextCheckpoint])
+                mNextCheckpoint++;
+        }
+
+        if (mTimeSinceStep < mOptions.stepTime)
+            return false;
+
+        mStalledSteps = currentIt == mPrevIt ? mStalledSteps + 1 : 0;
+        mPrevIt = currentIt;
+        if (isBlocked || mStalledSteps >= MAX_STALLED_STEPS)
+        {
+            mIsFinished = true;
+            return false;
+        }
+
+        mTimeSinceStep = 0.0f;
+        return true;
+    }
+
+    void Benchmark::EndFrame()
+    {
+        mCpuTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mFrameBegin).count());
+        if constexpr (AllocationTracker::IS_ENABLED)
+            mAllocations.push_back(static_cast<double>(AllocationTracker::GetCurrentFrameAllocations()));
+    }
+
+    bool Benchmark::IsFinished() const
+    {
+        // Checkpoints are read back while the frame renders, after the update that requested them.
+        return mIsFinished && !mPendingCaptures;
+    }
+
+    const BenchmarkOptions& Benchmark::GetOptions() const
+    {
+        return mOptions;
+    }
+
+    bool Benchmark::IsMatchingReference() const
+    {
+        return GetMismatches().empty();
+    }
+
+    bool Benchmark::WriteReport() const
+    {
+        std::ofstream file{mOptions.output};
+        if (!file.is_open())
+        {
+            OE_LOG_WARNING("Failed to open benchmark report '" + mOptions.output.string() + "'!");
+            return false;
+        }
+
+        const auto writeStats = [](YAML::Emitter& out, const std::string& name, const std::vector<double>& samples) {
+            const auto stats = CalculateStats(samples);
+            out << YAML::Key << name;
+            out << YAML::BeginMap; // Begin Stats
+            out << YAML::Key << "Average" << YAML::Value << stats.average;
+            out << YAML::Key << "Median" << YAML::Value << stats.median;
+            out << YAML::Key << "P99" << YAML::Value << stats.p99;
+            out << YAML::Key << "Max" << YAML::Value << stats.max;
+            out << YAML::EndMap; // End Stats
+        };
+
+        YAML::Emitter out{};
+        out << YAML::BeginMap; // Begin Root
+        out << YAML::Key << "Benchmark";
+        out << YAML::BeginMap; // Begin Benchmark
+        out << YAML::Key << "Renderer" << YAML::Value << reinterpret_cast<const char*>(gl::GetString(gl::RENDERER));
+        out << YAML::Key << "DeltaTime" << YAML::Value << mOptions.deltaTime;
+        out << YAML::Key << "Frames" << YAML::Value << mFrame;
+        out << YAML::Key << "LastIterator" << YAML::Value << mPrevIt;
+
+        out << YAML::Key << "TimingsMs";
+        out << YAML::BeginMap; // Begin TimingsMs
+        writeStats(out, "Update", mCpuTimes);
+        writeStats(out, "FrameInterval", mFrameIntervals);
+        writeStats(out, "GpuFrameInterval", mGpuIntervals);
+        out << YAML::EndMap; // End TimingsMs
+
+        if constexpr (AllocationTracker::IS_ENABLED)
+        {
+            out << YAML::Key << "Allocations";
+            out << YAML::BeginMap; // Begin Allocations
+            writeStats(out, "PerFrame", mAllocations);
+            for (uint8_t scope{}; scope < ALLOCATION_SCOPES_COUNT; ++scope)
+            {
+                const auto counters = AllocationTracker::GetCounters(static_cast<AllocationScope>(scope));
+                out << YAML::Key << AllocationTracker::GetScopeName(static_cast<AllocationScope>(scope));
+                out << YAML::BeginMap; // Begin Scope
+                out << YAML::Key << "LiveBytes" << YAML::Value << counters.liveBytes;
+                out << YAML::Key << "PeakBytes" << YAML::Value << counters.peakBytes;
+                out << YAML::Key << "Total" << YAML::Value << counters.allocations;
+                out << YAML::EndMap; // End Scope
+            }
+            out << YAML::EndMap; // End Allocations
+        }
+
+        out << YAML::Key << "Checkpoints";
+        out << YAML::BeginMap; // Begin Checkpoints
+        for (const auto& [iterator, hash] : mHashes)
+            out << YAML::Key << iterator << YAML::Value << ToHex(hash);
+        out << YAML::EndMap; // End Checkpoints
+
+        out << YAML::Key << "Mismatches";
+        out << YAML::BeginSeq; // Begin Mismatches
+        for (const auto iterator : GetMismatches())
+        {
+            OE_LOG_WARNING("Frame at iterator " + std::to_string(iterator) + " differs from the reference!");
+            out << iterator;
+        }
+        out << YAML::EndSeq; // End Mismatches
+
+        out << YAML::EndMap; // End Benchmark
+        out << YAML::EndMap; // End Root
+
+        file << out.c_str();
+        return true;
+    }
+
+    Benchmark::Stats Benchmark::CalculateStats(std::vector<double> samples)
+    {
+        if (samples.empty())
+            return {};
+        std::sort(samples.begin(), samples.end());
+        Stats stats{};
+        stats.average = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+        stats.median = samples[samples.size() / 2];
+        stats.p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+        stats.max = samples.back();
+        return stats;
+    }
+
+    std::vector<uint32_t> Benchmark::GetMismatches() const
+    {
+        // A reference checkpoint the run never reached counts as a mismatch too.
+        std::vector<uint32_t> mismatches{};
+        for (const auto& [iterator, hash] : mReferenceHashes)
+        {
+            const auto captured = mHashes.find(iterator);
+            if (captured == mHashes.end() || captured->second != hash)
+                mismatches.push_back(iterator);
+        }
+        return mismatches;
+    }
+
+    void Benchmark::CaptureCheckpoint(uint32_t iterator)
+    {
+        mPendingCaptures++;
+        RequestFrameCapture([this, iterator](const std::vector<uint8_t>& pixels, int, int) {
+            mHashes[iterator] = HashPixels(pixels);
+            mPendingCaptures--;
+        });
+    }
+
+    void Benchmark::ReadGpuTimestamps()
+    {
+        // Keep GPU_QUERIES_COUNT - 1 frames in flight so reading a result never stalls.
+        while (mReadQueries + GPU_QUERIES_COUNT - 1 < mFrame)
+        {
+            const auto query = mQueries[mReadQueries % GPU_QUERIES_COUNT];
+            uint64_t timestamp{};
+            gl::GetQueryObjectui64v(query, gl::QUERY_RESULT, &timestamp);
+            if (mReadQueries)
+                mGpuIntervals.push_back(static_cast<double>(timestamp - mPrevGpuTimestamp) / 1.0e6);
+            mPrevGpuTimestamp = timestamp;
+            mReadQueries++;
+        }
+    }
+} // namespace TSOCA
@@ -0,0 +1,88 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace TSOCA
+{
+    struct BenchmarkOptions
+    {
+        bool isEnabled{};
+        float deltaTime{1.0f / 60.0f};
+        // Simulated time between steps, and before hashing a checkpoint so transitions settle.
+        float stepTime{0.25f};
+        float settleTime{4.0f};
+        std::vector<uint32_t> checkpoints{};
+        std::filesystem::path output{"benchmark.yaml"};
+        std::filesystem::path reference{};
+    };
+
+    // Steps the script with a fixed delta time, hashes the drawn scene at checkpoint
+    // iterators and records frame timings. Run under Mesa's llvmpipe
+    // (LIBGL_ALWAYS_SOFTWARE=1, e.g. inside xvfb-run) to get comparable hashes on CI.
+    // World::UpdateEntities takes no delta time and keeps the engine's clock, so checkpoints
+    // wait settleTime for entity animations to end; the random waiting particles are not shown.
+    class Benchmark
+    {
+      public:
+        explicit Benchmark(BenchmarkOptions options);
+        ~Benchmark();
+
+        // False when a reference was given but is missing or unreadable.
+        bool LoadReference();
+
+        float BeginFrame();
+        // Returns true when the script should be stepped this frame.
+        bool Update(uint32_t currentIt, bool isBlocked);
+        void EndFrame();
+
+        [[nodiscard]] bool IsFinished() const;
+        [[nodiscard]] const BenchmarkOptions& GetOptions() const;
+        // True when every reference checkpoint was captured with the same hash.
+        [[nodiscard]] bool IsMatchingReference() const;
+        bool WriteReport() const;
+
+      private:
+        struct Stats
+        {
+            double average{};
+            double median{};
+            double p99{};
+            double max{};
+        };
+
+        static Stats CalculateStats(std::vector<double> samples);
+        [[nodiscard]] std::vector<uint32_t> GetMismatches() const;
+        void CaptureCheckpoint(uint32_t iterator);
+        void ReadGpuTimestamps();
+
+        BenchmarkOptions mOptions{};
+        std::map<uint32_t, uint64_t> mHashes{};
+        std::map<uint32_t, uint64_t> mReferenceHashes{};
+        std::vector<double> mCpuTimes{};
+        std::vector<double> mFrameIntervals{};
+        std::vector<double> mGpuIntervals{};
+        std::vector<double> mAllocations{};
+        std::vector<uint32_t> mQueries{};
+        std::chrono::steady_clock::time_point mFrameBegin{};
+        std::chrono::steady_clock::time_point mPrevFrameBegin{};
+        size_t mNextCheckpoint{};
+        uint64_t mFrame{};
+        uint64_t mReadQueries{};
+        uint64_t mPrevGpuTimestamp{};
+        float mTimeSinceStep{};
+        uint32_t mPrevIt{};
+        uint32_t mStalledSteps{};
+        uint32_t mPendingCaptures{};
+        bool mIsFinished{};
+    };
+} // namespace TSOCA
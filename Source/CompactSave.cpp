@@ -0,0 +1,206 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "CompactSave.hpp"
+#include "MappedFile.hpp"
+#include "Oneiro/VisualNovel/VNCore.hpp"
+#include "TextUtils.hpp"
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+
+namespace TSOCA
+{
+    namespace
+    {
+        void WriteVarUInt(std::vector<uint8_t>& out, uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                out.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        void WriteFixedUInt(std::vector<uint8_t>& out, uint32_t value)
+        {
+            for (int i{}; i < 4; ++i)
+                out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+
+        void WriteString(std::vector<uint8_t>& out, const std::string& value)
+        {
+            WriteVarUInt(out, static_cast<uint32_t>(value.size()));
+            out.insert(out.end(), value.begin(), value.end());
+        }
+
+        class Reader
+        {
+          public:
+            Reader(const uint8_t* data, size_t size) : mData(data), mEnd(data + size)
+            {
+            }
+
+            bool ReadVarUInt(uint32_t& value)
+            {
+                value = 0;
+                for (int shift{}; shift < 35; shift += 7)
+                {
+                    if (mData == mEnd)
+                        return false;
+                    const uint8_t byte = *mData++;
+                    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                    if (!(byte & 0x80))
+                        return true;
+                }
+                return false;
+            }
+
+            bool ReadFixedUInt(uint32_t& value)
+            {
+                if (mEnd - mData < 4)
+                    return false;
+                value = 0;
+                for (int i{}; i < 4; ++i)
+                    value |= static_cast<uint32_t>(*mData++) << (i * 8);
+                return true;
+            }
+
+            bool ReadString(std::string& value)
+            {
+                uint32_t size{};
+                if (!ReadVarUInt(size) || static_cast<size_t>(mEnd - mData) < size)
+                    return false;
+                value.assign(reinterpret_cast<const char*>(mData), size);
+                mData += size;
+                return true;
+            }
+
+          private:
+            const uint8_t* mData{};
+            const uint8_t* mEnd{};
+        };
+
+        bool DecodeV1(Reader& reader, CompactSave& save)
+        {
+            return reader.ReadString(save.label) && reader.ReadVarUInt(save.iterator) && reader.ReadFixedUInt(save.anchorHash) &&
+                   reader.ReadVarUInt(save.anchorOffset);
+        }
+    } // namespace
+
+    std::vector<uint8_t> EncodeCompactSave(const CompactSave& save)
+    {
+        std::vector<uint8_t> out{};
+        out.reserve(32 + save.label.size());
+        WriteFixedUInt(out, CompactSave::MAGIC);
+        WriteVarUInt(out, CompactSave::VERSION);
+        WriteString(out, save.label);
+        WriteVarUInt(out, save.iterator);
+        WriteFixedUInt(out, save.anchorHash);
+        WriteVarUInt(out, save.anchorOffset);
+        return out;
+    }
+
+    bool DecodeCompactSave(const uint8_t* data, size_t size, CompactSave& save)
+    {
+        Reader reader{data, size};
+        uint32_t magic{};
+        uint32_t version{};
+        if (!reader.ReadFixedUInt(magic) || magic != CompactSave::MAGIC || !reader.ReadVarUInt(version))
+            return false;
+
+        // Older layouts are decoded into the current struct here, one case per version.
+        switch (version)
+        {
+        case 1: return DecodeV1(reader, save);
+        default: return false;
+        }
+    }
+
+    bool WriteCompactSave(const std::filesystem::path& path, const CompactSave& save)
+    {
+        const auto data = EncodeCompactSave(save);
+        auto tempPath = path;
+        tempPath += ".tmp";
+        {
+            std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+            if (!file.is_open())
+                return false;
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file.good())
+                return false;
+        }
+        std::error_code error{};
+        std::filesystem::rename(tempPath, path, error);
+        return !error;
+    }
+
+    bool ReadCompactSave(const std::filesystem::path& path, CompactSave& save)
+    {
+        MappedFile file{};
+        if (!file.Open(path))
+            return false;
+        return DecodeCompactSave(reinterpret_cast<const uint8_t*>(file.GetData()), file.GetSize(), save);
+    }
+
+    CompactSave CaptureCompactSave()
+    {
+        using namespace oe;
+        CompactSave save{};
+        save.label = VisualNovel::GetCurrentLabel();
+        save.iterator = VisualNovel::GetCurrentIterator();
+
+        const auto& instructions = VisualNovel::GetInstructions();
+        for (auto i = static_cast<int64_t>(save.iterator) - 1; i >= 0; --i)
+        {
+            if (instructions[i].EqualType(VisualNovel::SAY_TEXT))
+            {
+                save.anchorHash = HashString(instructions[i].characterData.text);
+                save.anchorOffset = save.iterator - static_cast<uint32_t>(i);
+                break;
+            }
+        }
+        return save;
+    }
+
+    uint32_t ResolveCompactSaveIterator(const CompactSave& save)
+    {
+        using namespace oe;
+        const auto& instructions = VisualNovel::GetInstructions();
+        const auto size = static_cast<uint32_t>(instructions.size());
+        if (!save.anchorOffset)
+            return std::min(save.iterator, size);
+
+        // Label the engine reports once the first i instructions ran; the same line can appear in several labels.
+        std::vector<std::string_view> labels(size + 1);
+        labels[0] = "start";
+        for (uint32_t i{}; i < size; ++i)
+        {
+            const auto& instruction = instructions[i];
+            labels[i + 1] = instruction.EqualType(VisualNovel::JUMP_TO_LABEL) ? std::string_view{instruction.label.name} : labels[i];
+        }
+
+        const auto matches = [&](uint32_t iterator) {
+            if (iterator < save.anchorOffset || iterator > size || (!save.label.empty() && labels[iterator] != save.label))
+                return false;
+            const auto& anchor = instructions[iterator - save.anchorOffset];
+            return anchor.EqualType(VisualNovel::SAY_TEXT) && HashString(anchor.characterData.text) == save.anchorHash;
+        };
+
+        if (matches(save.iterator))
+            return save.iterator;
+
+        // The script changed: look for the anchor line nearest to where it used to be.
+        for (uint32_t distance = 1; distance <= size; ++distance)
+        {
+            if (save.iterator >= distance && matches(save.iterator - distance))
+                return save.iterator - distance;
+            if (matches(save.iterator + distance))
+                return save.iterator + distance;
+        }
+        return std::min(save.iterator, size);
+    }
+} // namespace TSOCA
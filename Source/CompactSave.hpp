@@ -0,0 +1,38 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace TSOCA
+{
+    // Everything else (background, characters, music, text box) is rebuilt by replaying the
+    // script up to the iterator, so a save only has to store where to stop.
+    struct CompactSave
+    {
+        static constexpr uint32_t MAGIC{0x53565354}; // "TSVS"
+        static constexpr uint32_t VERSION{1};
+
+        std::string label{};
+        uint32_t iterator{};
+        // Hash of the last said line and the distance from it to the iterator, used to find
+        // the same place again after the script was edited.
+        uint32_t anchorHash{};
+        uint32_t anchorOffset{};
+    };
+
+    std::vector<uint8_t> EncodeCompactSave(const CompactSave& save);
+    bool DecodeCompactSave(const uint8_t* data, size_t size, CompactSave& save);
+
+    bool WriteCompactSave(const std::filesystem::path& path, const CompactSave& save);
+    bool ReadCompactSave(const std::filesystem::path& path, CompactSave& save);
+
+    CompactSave CaptureCompactSave();
+    uint32_t ResolveCompactSaveIterator(const CompactSave& save);
+} // namespace TSOCA
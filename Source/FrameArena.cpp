@@ -0,0 +1,126 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace TSOCA
+{
+    FrameArena::FrameArena(size_t capacity) : mBuffer(capacity)
+    {
+        mArena.emplace(mBuffer.data(), mBuffer.size(), &mHeap);
+    }
+
+    const char* FrameArena::Format(const char* format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        va_list argsCopy;
+        va_copy(argsCopy, args);
+        const int size = std::vsnprintf(nullptr, 0, format, argsCopy);
+        va_end(argsCopy);
+        if (size < 0)
+        {
+            va_end(args);
+            return "";
+        }
+        auto* text = static_cast<char*>(allocate(static_cast<size_t>(size) + 1, alignof(char)));
+        std::vsnprintf(text, static_cast<size_t>(size) + 1, format, args);
+        va_end(args);
+        return text;
+    }
+
+    const char* FrameArena::Copy(std::string_view text)
+    {
+        auto* copy = static_cast<char*>(allocate(text.size() + 1, alignof(char)));
+        std::memcpy(copy, text.data(), text.size());
+        copy[text.size()] = '\0';
+        return copy;
+    }
+
+    FrameString FrameArena::ToString(const std::filesystem::path& path)
+    {
+        return path.string<char, std::char_traits<char>, std::pmr::polymorphic_allocator<char>>(this);
+    }
+
+    FrameString FrameArena::MakeString(std::string_view text)
+    {
+        return FrameString{text, this};
+    }
+
+    void FrameArena::Reset()
+    {
+        mFrameAllocations = mAllocations;
+        mFrameBytes = mBytes;
+        mFrameHeapAllocations = mHeap.mAllocations;
+        mAllocations = 0;
+        mBytes = 0;
+        mHeap.mAllocations = 0;
+
+        mArena->release();
+        if (mFrameHeapAllocations)
+        {
+            // The frame did not fit, so the next one gets a buffer with room to spare.
+            mArena.reset();
+            mBuffer.resize(std::max(mBuffer.size() * 2, mFrameBytes * 2));
+            mArena.emplace(mBuffer.data(), mBuffer.size(), &mHeap);
+        }
+    }
+
+    uint32_t FrameArena::GetFrameAllocations() const
+    {
+        return mFrameAllocations;
+    }
+
+    size_t FrameArena::GetFrameBytes() const
+    {
+        return mFrameBytes;
+    }
+
+    uint32_t FrameArena::GetFrameHeapAllocations() const
+    {
+        return mFrameHeapAllocations;
+    }
+
+    size_t FrameArena::GetCapacity() const
+    {
+        return mBuffer.size();
+    }
+
+    void* FrameArena::do_allocate(size_t bytes, size_t alignment)
+    {
+        mAllocations++;
+        mBytes += bytes;
+        return mArena->allocate(bytes, alignment);
+    }
+
+    void FrameArena::do_deallocate(void*, size_t, size_t)
+    {
+    }
+
+    bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    void* FrameArena::HeapCounter::do_allocate(size_t bytes, size_t alignment)
+    {
+        mAllocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void FrameArena::HeapCounter::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+    {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool FrameArena::HeapCounter::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+} // namespace TSOCA
@@ -0,0 +1,69 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace TSOCA
+{
+    using FrameString = std::pmr::string;
+
+    // Linear allocator for strings that only live until the end of the frame.
+    // Reset() releases everything at once and grows the buffer if the frame spilled to the heap.
+    class FrameArena : public std::pmr::memory_resource
+    {
+      public:
+        explicit FrameArena(size_t capacity = 64 * 1024);
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        // printf-style formatting into the arena, the result is valid until Reset().
+        const char* Format(const char* format, ...);
+        const char* Copy(std::string_view text);
+        FrameString ToString(const std::filesystem::path& path);
+        FrameString MakeString(std::string_view text = {});
+
+        void Reset();
+
+        // Statistics of the last finished frame.
+        [[nodiscard]] uint32_t GetFrameAllocations() const;
+        [[nodiscard]] size_t GetFrameBytes() const;
+        [[nodiscard]] uint32_t GetFrameHeapAllocations() const;
+        [[nodiscard]] size_t GetCapacity() const;
+
+      private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        class HeapCounter : public std::pmr::memory_resource
+        {
+          public:
+            uint32_t mAllocations{};
+
+          private:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+            [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+        };
+
+        std::vector<std::byte> mBuffer{};
+        HeapCounter mHeap{};
+        std::optional<std::pmr::monotonic_buffer_resource> mArena{};
+        uint32_t mAllocations{};
+        size_t mBytes{};
+        uint32_t mFrameAllocations{};
+        size_t mFrameBytes{};
+        uint32_t mFrameHeapAllocations{};
+    };
+} // namespace TSOCA
@@ -0,0 +1,61 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "FrameCapture.hpp"
+#include "Oneiro/Renderer/OpenGL/Texture.hpp"
+#include "imgui.h"
+
+namespace TSOCA
+{
+    namespace
+    {
+        std::vector<FrameCaptureCallback>& GetRequests()
+        {
+            static std::vector<FrameCaptureCallback> requests{};
+            return requests;
+        }
+
+        // Runs inside the GUI renderer, which draws the background list before any window.
+        void CaptureBackBuffer(const ImDrawList*, const ImDrawCmd*)
+        {
+            auto& requests = GetRequests();
+            const auto* drawData = ImGui::GetDrawData();
+            const int width = drawData ? static_cast<int>(drawData->DisplaySize.x * drawData->FramebufferScale.x) : 0;
+            const int height = drawData ? static_cast<int>(drawData->DisplaySize.y * drawData->FramebufferScale.y) : 0;
+            if (requests.empty() || width <= 0 || height <= 0)
+                return;
+
+            std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+            int prevReadFramebuffer{};
+            int prevPackAlignment{};
+            gl::GetIntegerv(gl::READ_FRAMEBUFFER_BINDING, &prevReadFramebuffer);
+            gl::GetIntegerv(gl::PACK_ALIGNMENT, &prevPackAlignment);
+            gl::BindFramebuffer(gl::READ_FRAMEBUFFER, 0);
+            gl::ReadBuffer(gl::BACK);
+            gl::PixelStorei(gl::PACK_ALIGNMENT, 1);
+            gl::ReadPixels(0, 0, width, height, gl::RGBA, gl::UNSIGNED_BYTE, pixels.data());
+            gl::PixelStorei(gl::PACK_ALIGNMENT, prevPackAlignment);
+            gl::BindFramebuffer(gl::READ_FRAMEBUFFER, prevReadFramebuffer);
+
+            // Callbacks may queue new requests; those go into the next frame.
+            const auto callbacks = std::move(requests);
+            requests.clear();
+            for (const auto& callback : callbacks)
+                callback(pixels, width, height);
+        }
+    } // namespace
+
+    void RequestFrameCapture(FrameCaptureCallback callback)
+    {
+        GetRequests().push_back(std::move(callback));
+    }
+
+    void ScheduleFrameCaptures()
+    {
+        // Re-added every frame until it runs, since a minimized window renders no GUI.
+        if (!GetRequests().empty())
+            ImGui::GetBackgroundDrawList()->AddCallback(&CaptureBackBuffer, nullptr);
+    }
+} // namespace TSOCA
@@ -0,0 +1,22 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace TSOCA
+{
+    // Receives bottom-up RGBA8 rows of the drawn scene.
+    using FrameCaptureCallback = std::function<void(const std::vector<uint8_t>& pixels, int width, int height)>;
+
+    // Queues a read of the back buffer, made from the GUI renderer once the scene is drawn and before
+    // the GUI is drawn over it and the buffers are swapped.
+    void RequestFrameCapture(FrameCaptureCallback callback);
+    // Call once per GUI frame; schedules the queued captures in this frame's GUI draw data.
+    void ScheduleFrameCaptures();
+} // namespace TSOCA
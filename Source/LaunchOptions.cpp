@@ -0,0 +1,90 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "LaunchOptions.hpp"
+#include "Oneiro/Runtime/Engine.hpp"
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+#include <string_view>
+
+namespace TSOCA
+{
+    namespace
+    {
+        template <class T> bool ParseNumber(std::string_view arg, std::string_view value, T& result)
+        {
+            T parsed{};
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+            if (error != std::errc{} || end != value.data() + value.size())
+            {
+                OE_LOG_WARNING("Ignoring invalid launch option '" + std::string(arg) + "'!");
+                return false;
+            }
+            result = parsed;
+            return true;
+        }
+    } // namespace
+
+    LaunchOptions LaunchOptions::Parse(int argc, char* argv[])
+    {
+        LaunchOptions options{};
+        auto& benchmark = options.benchmark;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view arg{argv[i]};
+            const auto value = [&](std::string_view name) {
+                return arg.substr(0, name.size()) == name ? arg.substr(name.size()) : std::string_view{};
+            };
+
+            if (arg == "--benchmark")
+                benchmark.isEnabled = true;
+            else if (arg == "--hot-reload")
+                options.isHotReloadEnabled = true;
+            else if (const auto output = value("--benchmark-output="); !output.empty())
+                benchmark.output = std::string(output);
+            else if (const auto reference = value("--benchmark-reference="); !reference.empty())
+                benchmark.reference = std::string(reference);
+            else if (const auto deltaTime = value("--delta-time="); !deltaTime.empty())
+            {
+                // The benchmark only steps once simulated time passes, so it must advance.
+                float parsed{};
+                if (!ParseNumber(arg, deltaTime, parsed))
+                    continue;
+                if (parsed > 0.0f)
+                    benchmark.deltaTime = parsed;
+                else
+                    OE_LOG_WARNING("Benchmark delta time must be positive, keeping " + std::to_string(benchmark.deltaTime) + "!");
+            }
+            else if (const auto checkpoints = value("--checkpoints="); !checkpoints.empty())
+            {
+                std::istringstream stream{std::string(checkpoints)};
+                std::string checkpoint{};
+                while (std::getline(stream, checkpoint, ','))
+                {
+                    uint32_t parsed{};
+                    if (ParseNumber(arg, checkpoint, parsed))
+                        benchmark.checkpoints.push_back(parsed);
+                }
+                std::sort(benchmark.checkpoints.begin(), benchmark.checkpoints.end());
+            }
+            else if (const auto analysis = value("--analyze-script="); !analysis.empty())
+                options.scriptAnalysisOutput = std::string(analysis);
+            else if (const auto budget = value("--memory-budget-mb="); !budget.empty())
+            {
+                uint64_t parsed{};
+                if (ParseNumber(arg, budget, parsed))
+                    options.memoryBudget = parsed * 1024 * 1024;
+            }
+            else if (const auto trace = value("--trace="); !trace.empty())
+                options.traceOutput = std::string(trace);
+            else if (const auto stringsExport = value("--export-strings="); !stringsExport.empty())
+                options.stringsExport = std::string(stringsExport);
+            else if (const auto stringsSource = value("--compile-strings="); !stringsSource.empty())
+                options.stringsSource = std::string(stringsSource);
+        }
+        return options;
+    }
+} // namespace TSOCA
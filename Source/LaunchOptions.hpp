@@ -0,0 +1,36 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Benchmark.hpp"
+#include <filesystem>
+
+namespace TSOCA
+{
+    struct LaunchOptions
+    {
+        BenchmarkOptions benchmark{};
+        // --analyze-script=report.yaml writes the script's resource graph and exits.
+        std::filesystem::path scriptAnalysisOutput{};
+        uint64_t memoryBudget{};
+        // --trace=trace.json records a Chrome trace from startup until exit.
+        std::filesystem::path traceOutput{};
+        // --export-strings=ru.yaml writes the script's say lines for translators and exits.
+        std::filesystem::path stringsExport{};
+        // --compile-strings=en.yaml writes the string table en.oestrings next to it and exits.
+        std::filesystem::path stringsSource{};
+        // --hot-reload watches Assets/Scripts and reloads changed scripts in place.
+        bool isHotReloadEnabled{};
+
+        // Tool runs never touch the player's saves or config.
+        [[nodiscard]] bool IsToolRun() const
+        {
+            return benchmark.isEnabled || !scriptAnalysisOutput.empty() || !stringsExport.empty() || !stringsSource.empty();
+        }
+
+        static LaunchOptions Parse(int argc, char* argv[]);
+    };
+} // namespace TSOCA
@@ -0,0 +1,268 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "LuaHeap.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <lua.hpp>
+#include <new>
+
+namespace TSOCA
+{
+    LuaPoolAllocator::~LuaPoolAllocator()
+    {
+        for (const auto& slab : mSlabs)
+            std::free(slab.data);
+    }
+
+    void* LuaPoolAllocator::Allocate(void* userData, void* ptr, size_t oldSize, size_t newSize)
+    {
+        auto& allocator = *static_cast<LuaPoolAllocator*>(userData);
+        // For new blocks Lua passes the object type in oldSize.
+        if (!ptr)
+            oldSize = 0;
+
+        if (!newSize)
+        {
+            if (ptr)
+                allocator.ReleaseBlock(ptr, oldSize);
+            return nullptr;
+        }
+
+        // A block kept through a failed shrink is larger than oldSize says, so its class comes from the slab.
+        const auto* slab = ptr ? allocator.FindSlab(ptr) : nullptr;
+        const auto oldClass = slab ? slab->sizeClass : NO_CLASS;
+        const auto newClass = GetSizeClass(newSize);
+        // Lua assumes a shrink never fails, so the old block is kept when no new one can be had.
+        const bool isShrink = ptr && newSize <= oldSize;
+        if (ptr && oldClass == newClass)
+        {
+            if (newClass != NO_CLASS)
+                return ptr;
+            allocator.mLargeAllocations++;
+            auto* block = std::realloc(ptr, newSize);
+            return block || !isShrink ? block : ptr;
+        }
+
+        auto* block = allocator.AllocateBlock(newSize);
+        if (!block)
+            return isShrink ? ptr : nullptr;
+        if (ptr)
+        {
+            std::memcpy(block, ptr, std::min(oldSize, newSize));
+            allocator.ReleaseBlock(ptr, oldSize);
+        }
+        return block;
+    }
+
+    void LuaPoolAllocator::ReleaseEmptySlabs()
+    {
+        const auto isEmpty = [](const Slab& slab) { return !slab.usedBlocks; };
+        if (std::none_of(mSlabs.begin(), mSlabs.end(), isEmpty))
+            return;
+
+        for (auto& freeList : mFreeLists)
+        {
+            auto** link = &freeList;
+            while (*link)
+            {
+                if (isEmpty(*FindSlab(*link)))
+                    *link = (*link)->next;
+                else
+                    link = &(*link)->next;
+            }
+        }
+        for (const auto& slab : mSlabs)
+        {
+            if (isEmpty(slab))
+                std::free(slab.data);
+        }
+        std::erase_if(mSlabs, isEmpty);
+    }
+
+    size_t LuaPoolAllocator::GetPoolBytes() const
+    {
+        return mSlabs.size() * SLAB_SIZE;
+    }
+
+    uint32_t LuaPoolAllocator::GetSlabsCount() const
+    {
+        return static_cast<uint32_t>(mSlabs.size());
+    }
+
+    uint64_t LuaPoolAllocator::GetPooledAllocations() const
+    {
+        return mPooledAllocations;
+    }
+
+    uint64_t LuaPoolAllocator::GetLargeAllocations() const
+    {
+        return mLargeAllocations;
+    }
+
+    uint32_t LuaPoolAllocator::GetSizeClass(size_t size)
+    {
+        const auto it = std::lower_bound(SIZE_CLASSES.begin(), SIZE_CLASSES.end(), size);
+        return static_cast<uint32_t>(it - SIZE_CLASSES.begin());
+    }
+
+    void* LuaPoolAllocator::AllocateBlock(size_t size)
+    {
+        const auto sizeClass = GetSizeClass(size);
+        if (sizeClass == NO_CLASS)
+        {
+            mLargeAllocations++;
+            return std::malloc(size);
+        }
+
+        auto& freeList = mFreeLists[sizeClass];
+        if (!freeList)
+        {
+            auto* data = static_cast<std::byte*>(std::malloc(SLAB_SIZE));
+            if (!data)
+                return nullptr;
+            const Slab slab{data, sizeClass};
+            mSlabs.insert(std::upper_bound(mSlabs.begin(), mSlabs.end(), slab,
+                                           [](const Slab& lhs, const Slab& rhs) { return lhs.data < rhs.data; }),
+                          slab);
+            const auto blockSize = SIZE_CLASSES[sizeClass];
+            for (auto offset = SLAB_SIZE / blockSize * blockSize; offset >= blockSize; offset -= blockSize)
+                freeList = new (data + offset - blockSize) FreeNode{freeList};
+        }
+
+        auto* block = freeList;
+        freeList = block->next;
+        FindSlab(block)->usedBlocks++;
+        mPooledAllocations++;
+        return block;
+    }
+
+    void LuaPoolAllocator::ReleaseBlock(void* ptr, size_t)
+    {
+        auto* slab = FindSlab(ptr);
+        if (!slab)
+        {
+            std::free(ptr);
+            return;
+        }
+        slab->usedBlocks--;
+        // Lua always passes the block's size, but the slab knows its class for certain.
+        auto& freeList = mFreeLists[slab->sizeClass];
+        freeList = new (ptr) FreeNode{freeList};
+    }
+
+    LuaPoolAllocator::Slab* LuaPoolAllocator::FindSlab(const void* ptr)
+    {
+        const auto* address = static_cast<const std::byte*>(ptr);
+        const auto it = std::upper_bound(mSlabs.begin(), mSlabs.end(), address,
+                                         [](const std::byte* value, const Slab& slab) { return value < slab.data; });
+        if (it == mSlabs.begin())
+            return nullptr;
+        auto& slab = *std::prev(it);
+        return address < slab.data + SLAB_SIZE ? &slab : nullptr;
+    }
+
+    void LuaHeap::Install(lua_State* state)
+    {
+        mState = state;
+        lua_setallocf(state, &LuaPoolAllocator::Allocate, &mAllocator);
+        lua_gc(state, LUA_GCSTOP, 0);
+        mHeapAfterCycle = GetHeapBytes();
+    }
+
+    void LuaHeap::Step(float budgetMs)
+    {
+        // Small steps keep a single one from overrunning the budget by much.
+        static constexpr int STEP_KB{16};
+        // A heap that outgrows the collector gets bigger steps and a larger, still bounded, budget to catch up.
+        static constexpr int CATCH_UP_STEP_KB{256};
+        static constexpr float CATCH_UP_BUDGET_SCALE{4.0f};
+        if (!mState || mAutoCollectDepth)
+            return;
+
+        const auto begin = std::chrono::steady_clock::now();
+        const auto elapsed = [&begin] {
+            return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        };
+
+        const auto heapBytes = GetHeapBytes();
+        // Nothing was allocated since the last cycle, so there is nothing new to collect.
+        if (heapBytes > mHeapAfterCycle)
+        {
+            const bool isCatchUp = heapBytes > mHeapAfterCycle * 4 + 8 * 1024 * 1024;
+            const int stepKb = isCatchUp ? CATCH_UP_STEP_KB : STEP_KB;
+            if (isCatchUp)
+            {
+                budgetMs *= CATCH_UP_BUDGET_SCALE;
+                mCatchUpFramesCount++;
+            }
+            while (elapsed() < budgetMs)
+            {
+                if (lua_gc(mState, LUA_GCSTEP, stepKb))
+                {
+                    mAllocator.ReleaseEmptySlabs();
+                    mHeapAfterCycle = GetHeapBytes();
+                    mCyclesCount++;
+                    break;
+                }
+            }
+        }
+        mLastStepTime = elapsed();
+    }
+
+    void LuaHeap::BeginAutoCollect()
+    {
+        if (mState && !mAutoCollectDepth++)
+            lua_gc(mState, LUA_GCRESTART, 0);
+    }
+
+    void LuaHeap::EndAutoCollect()
+    {
+        if (!mState || !mAutoCollectDepth || --mAutoCollectDepth)
+            return;
+        lua_gc(mState, LUA_GCSTOP, 0);
+        mAllocator.ReleaseEmptySlabs();
+        mHeapAfterCycle = GetHeapBytes();
+    }
+
+    size_t LuaHeap::GetHeapBytes() const
+    {
+        if (!mState)
+            return 0;
+        return static_cast<size_t>(lua_gc(mState, LUA_GCCOUNT, 0)) * 1024 + static_cast<size_t>(lua_gc(mState, LUA_GCCOUNTB, 0));
+    }
+
+    float LuaHeap::GetLastStepTime() const
+    {
+        return mLastStepTime;
+    }
+
+    uint32_t LuaHeap::GetCyclesCount() const
+    {
+        return mCyclesCount;
+    }
+
+    uint32_t LuaHeap::GetCatchUpFramesCount() const
+    {
+        return mCatchUpFramesCount;
+    }
+
+    const LuaPoolAllocator& LuaHeap::GetAllocator() const
+    {
+        return mAllocator;
+    }
+
+    LuaAutoCollectScope::LuaAutoCollectScope(LuaHeap& heap) : mHeap(heap)
+    {
+        mHeap.BeginAutoCollect();
+    }
+
+    LuaAutoCollectScope::~LuaAutoCollectScope()
+    {
+        mHeap.EndAutoCollect();
+    }
+} // namespace TSOCA
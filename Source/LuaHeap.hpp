@@ -0,0 +1,110 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct lua_State;
+
+namespace TSOCA
+{
+    // Size-class pools for the small tables, strings and closures scripts create; larger blocks go to
+    // realloc. Blocks the state allocated before Install() are recognised by address and freed normally.
+    // Slabs left without live blocks stay on the free lists until ReleaseEmptySlabs().
+    class LuaPoolAllocator
+    {
+      public:
+        LuaPoolAllocator() = default;
+        ~LuaPoolAllocator();
+
+        LuaPoolAllocator(const LuaPoolAllocator&) = delete;
+        LuaPoolAllocator& operator=(const LuaPoolAllocator&) = delete;
+
+        // Signature of lua_Alloc; `userData` is the allocator.
+        static void* Allocate(void* userData, void* ptr, size_t oldSize, size_t newSize);
+        // Returns slabs without live blocks to the system; walks the free lists, so call it once per GC cycle.
+        void ReleaseEmptySlabs();
+
+        [[nodiscard]] size_t GetPoolBytes() const;
+        [[nodiscard]] uint32_t GetSlabsCount() const;
+        [[nodiscard]] uint64_t GetPooledAllocations() const;
+        [[nodiscard]] uint64_t GetLargeAllocations() const;
+
+      private:
+        static constexpr std::array<uint32_t, 10> SIZE_CLASSES{16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+        static constexpr size_t SLAB_SIZE{64 * 1024};
+        static constexpr uint32_t NO_CLASS{SIZE_CLASSES.size()};
+
+        struct FreeNode
+        {
+            FreeNode* next{};
+        };
+
+        struct Slab
+        {
+            std::byte* data{};
+            uint32_t sizeClass{};
+            uint32_t usedBlocks{};
+        };
+
+        static uint32_t GetSizeClass(size_t size);
+        void* AllocateBlock(size_t size);
+        void ReleaseBlock(void* ptr, size_t size);
+        [[nodiscard]] Slab* FindSlab(const void* ptr);
+
+        std::array<FreeNode*, SIZE_CLASSES.size()> mFreeLists{};
+        // Sorted by address for FindSlab().
+        std::vector<Slab> mSlabs{};
+        uint64_t mPooledAllocations{};
+        uint64_t mLargeAllocations{};
+    };
+
+    // Owns the state's allocator and garbage collector: automatic collection is stopped and the
+    // collector advances in small steps within a per-frame time budget instead.
+    class LuaHeap
+    {
+      public:
+        void Install(lua_State* state);
+        // Runs incremental steps until `budgetMs` is spent or a cycle finishes.
+        void Step(float budgetMs);
+        // Nestable; see LuaAutoCollectScope.
+        void BeginAutoCollect();
+        void EndAutoCollect();
+
+        [[nodiscard]] size_t GetHeapBytes() const;
+        [[nodiscard]] float GetLastStepTime() const;
+        [[nodiscard]] uint32_t GetCyclesCount() const;
+        [[nodiscard]] uint32_t GetCatchUpFramesCount() const;
+        [[nodiscard]] const LuaPoolAllocator& GetAllocator() const;
+
+      private:
+        LuaPoolAllocator mAllocator{};
+        lua_State* mState{};
+        size_t mHeapAfterCycle{};
+        float mLastStepTime{};
+        uint32_t mCyclesCount{};
+        uint32_t mCatchUpFramesCount{};
+        uint32_t mAutoCollectDepth{};
+    };
+
+    // Loading scripts and rebuilding the engine's instructions allocate far more than the per-frame steps
+    // reclaim, so Lua collects on its own while one of these is alive.
+    class LuaAutoCollectScope
+    {
+      public:
+        explicit LuaAutoCollectScope(LuaHeap& heap);
+        ~LuaAutoCollectScope();
+
+        LuaAutoCollectScope(const LuaAutoCollectScope&) = delete;
+        LuaAutoCollectScope& operator=(const LuaAutoCollectScope&) = delete;
+
+      private:
+        LuaHeap& mHeap;
+    };
+} // namespace TSOCA
@@ -0,0 +1,231 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace TSOCA
+{
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        Swap(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            Swap(other);
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        Close();
+    }
+
+    bool MappedFile::Open(const std::filesystem::path& path)
+    {
+        Close();
+#ifdef _WIN32
+        mFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (mFile == INVALID_HANDLE_VALUE)
+        {
+            mFile = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0)
+        {
+            Close();
+            return false;
+        }
+        mSize = static_cast<size_t>(size.QuadPart);
+
+        mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mMapping)
+        {
+            Close();
+            return false;
+        }
+
+        mData = static_cast<std::byte*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        mFd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (mFd < 0)
+            return false;
+
+        struct stat st
+        {
+        };
+        if (fstat(mFd, &st) != 0 || st.st_size == 0)
+        {
+            Close();
+            return false;
+        }
+        mSize = static_cast<size_t>(st.st_size);
+
+        void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFd, 0);
+        mData = data == MAP_FAILED ? nullptr : static_cast<std::byte*>(data);
+#endif
+        if (!mData)
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    bool MappedFile::OpenWritable(const std::filesystem::path& path, size_t size)
+    {
+        Close();
+#ifdef _WIN32
+        mFile = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+        if (mFile == INVALID_HANDLE_VALUE)
+        {
+            mFile = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(mFile, &fileSize))
+        {
+            Close();
+            return false;
+        }
+        mSize = std::max(size, static_cast<size_t>(fileSize.QuadPart));
+
+        const auto mappingSize = static_cast<uint64_t>(mSize);
+        mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READWRITE, static_cast<DWORD>(mappingSize >> 32),
+                                      static_cast<DWORD>(mappingSize & 0xFFFFFFFF), nullptr);
+        if (!mMapping)
+        {
+            Close();
+            return false;
+        }
+
+        mData = static_cast<std::byte*>(MapViewOfFile(mMapping, FILE_MAP_WRITE, 0, 0, 0));
+#else
+        mFd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (mFd < 0)
+            return false;
+
+        struct stat st
+        {
+        };
+        if (fstat(mFd, &st) != 0)
+        {
+            Close();
+            return false;
+        }
+        mSize = std::max(size, static_cast<size_t>(st.st_size));
+        if (static_cast<size_t>(st.st_size) < mSize && ftruncate(mFd, static_cast<off_t>(mSize)) != 0)
+        {
+            Close();
+            return false;
+        }
+
+        void* data = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+        mData = data == MAP_FAILED ? nullptr : static_cast<std::byte*>(data);
+#endif
+        if (!mData)
+        {
+            Close();
+            return false;
+        }
+        mIsWritable = true;
+        return true;
+    }
+
+    void MappedFile::Flush()
+    {
+        if (!mData || !mIsWritable)
+            return;
+#ifdef _WIN32
+        FlushViewOfFile(mData, 0);
+#else
+        msync(mData, mSize, MS_ASYNC);
+#endif
+    }
+
+    void MappedFile::Close()
+    {
+#ifdef _WIN32
+        if (mData)
+            UnmapViewOfFile(mData);
+        if (mMapping)
+            CloseHandle(mMapping);
+        if (mFile)
+            CloseHandle(mFile);
+        mMapping = nullptr;
+        mFile = nullptr;
+#else
+        if (mData)
+            munmap(mData, mSize);
+        if (mFd >= 0)
+            close(mFd);
+        mFd = -1;
+#endif
+        mData = nullptr;
+        mSize = 0;
+        mIsWritable = false;
+    }
+
+    bool MappedFile::IsOpen() const
+    {
+        return mData != nullptr;
+    }
+
+    bool MappedFile::IsWritable() const
+    {
+        return mIsWritable;
+    }
+
+    const std::byte* MappedFile::GetData() const
+    {
+        return mData;
+    }
+
+    std::byte* MappedFile::GetMutableData()
+    {
+        return mIsWritable ? mData : nullptr;
+    }
+
+    size_t MappedFile::GetSize() const
+    {
+        return mSize;
+    }
+
+    void MappedFile::Swap(MappedFile& other) noexcept
+    {
+#ifdef _WIN32
+        std::swap(mFile, other.mFile);
+        std::swap(mMapping, other.mMapping);
+#else
+        std::swap(mFd, other.mFd);
+#endif
+        std::swap(mData, other.mData);
+        std::swap(mSize, other.mSize);
+        std::swap(mIsWritable, other.mIsWritable);
+    }
+} // namespace TSOCA
@@ -0,0 +1,50 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace TSOCA
+{
+    class MappedFile
+    {
+      public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile();
+
+        bool Open(const std::filesystem::path& path);
+        // Maps the file for writing, creating it or growing it to at least `size` bytes.
+        bool OpenWritable(const std::filesystem::path& path, size_t size);
+        void Close();
+
+        // Asks the OS to start writing dirty pages back without waiting for it.
+        void Flush();
+
+        [[nodiscard]] bool IsOpen() const;
+        [[nodiscard]] bool IsWritable() const;
+        [[nodiscard]] const std::byte* GetData() const;
+        [[nodiscard]] std::byte* GetMutableData();
+        [[nodiscard]] size_t GetSize() const;
+
+      private:
+        void Swap(MappedFile& other) noexcept;
+
+#ifdef _WIN32
+        void* mFile{};
+        void* mMapping{};
+#else
+        int mFd{-1};
+#endif
+        std::byte* mData{};
+        size_t mSize{};
+        bool mIsWritable{};
+    };
+} // namespace TSOCA
@@ -0,0 +1,50 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "RollbackBuffer.hpp"
+
+namespace TSOCA
+{
+    RollbackBuffer::RollbackBuffer(size_t capacity) : mIterators(capacity)
+    {
+    }
+
+    void RollbackBuffer::Push(uint32_t iterator)
+    {
+        if (mIterators.empty())
+            return;
+        if (mCount == mIterators.size())
+        {
+            mHead = (mHead + 1) % mIterators.size();
+            --mCount;
+        }
+        mIterators[(mHead + mCount++) % mIterators.size()] = iterator;
+    }
+
+    bool RollbackBuffer::Rewind(uint32_t steps, uint32_t& iterator)
+    {
+        if (!steps || !mCount)
+            return false;
+        for (uint32_t i{}; i < steps && mCount; ++i)
+            iterator = mIterators[(mHead + --mCount) % mIterators.size()];
+        return true;
+    }
+
+    void RollbackBuffer::Clear()
+    {
+        mHead = 0;
+        mCount = 0;
+    }
+
+    size_t RollbackBuffer::GetCount() const
+    {
+        return mCount;
+    }
+
+    size_t RollbackBuffer::GetCapacity() const
+    {
+        return mIterators.size();
+    }
+} // namespace TSOCA
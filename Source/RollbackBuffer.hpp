@@ -0,0 +1,35 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace TSOCA
+{
+    // Iterators of the lines the player went through. Rewinding restarts the script and replays up to
+    // one of them, so the scene, characters and audio are rebuilt by the engine itself.
+    class RollbackBuffer
+    {
+      public:
+        explicit RollbackBuffer(size_t capacity = 4096);
+
+        void Push(uint32_t iterator);
+
+        // Drops the latest `steps` iterators and returns the oldest dropped one.
+        bool Rewind(uint32_t steps, uint32_t& iterator);
+        void Clear();
+
+        [[nodiscard]] size_t GetCount() const;
+        [[nodiscard]] size_t GetCapacity() const;
+
+      private:
+        std::vector<uint32_t> mIterators{};
+        size_t mHead{};
+        size_t mCount{};
+    };
+} // namespace TSOCA
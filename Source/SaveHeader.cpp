@@ -0,0 +1,171 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "SaveHeader.hpp"
+#include "MappedFile.hpp"
+#include "Oneiro/Renderer/OpenGL/Texture.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace TSOCA
+{
+    bool SaveHeader::IsValid() const
+    {
+        return magic == MAGIC && version == VERSION;
+    }
+
+    std::filesystem::path GetSaveHeaderPath(const std::filesystem::path& save)
+    {
+        auto path = save;
+        return path.replace_extension(".oemeta");
+    }
+
+    bool WriteSaveHeader(const std::filesystem::path& save, const SaveHeader& header)
+    {
+        std::ofstream file{GetSaveHeaderPath(save), std::ios::binary | std::ios::trunc};
+        if (!file.is_open())
+            return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(SaveHeader));
+        return file.good();
+    }
+
+    bool ReadSaveHeader(const std::filesystem::path& save, SaveHeader& header)
+    {
+        MappedFile file{};
+        if (!file.Open(GetSaveHeaderPath(save)) || file.GetSize() < sizeof(SaveHeader))
+            return false;
+        std::memcpy(&header, file.GetData(), sizeof(SaveHeader));
+        header.label[sizeof(header.label) - 1] = '\0';
+        header.lastLine[sizeof(header.lastLine) - 1] = '\0';
+        return header.IsValid();
+    }
+
+    void FillThumbnail(SaveHeader& header, const std::vector<uint8_t>& pixels, int framebufferWidth, int framebufferHeight)
+    {
+        constexpr auto dstWidth = SaveHeader::THUMBNAIL_WIDTH;
+        constexpr auto dstHeight = SaveHeader::THUMBNAIL_HEIGHT;
+        for (uint32_t y{}; y < dstHeight; ++y)
+        {
+            const uint32_t srcY0 = y * framebufferHeight / dstHeight;
+            const uint32_t srcY1 = std::max(srcY0 + 1, (y + 1) * framebufferHeight / dstHeight);
+            for (uint32_t x{}; x < dstWidth; ++x)
+            {
+                const uint32_t srcX0 = x * framebufferWidth / dstWidth;
+                const uint32_t srcX1 = std::max(srcX0 + 1, (x + 1) * framebufferWidth / dstWidth);
+                uint32_t sum[4]{};
+                for (uint32_t sy = srcY0; sy < srcY1; ++sy)
+                {
+                    const uint8_t* row = pixels.data() + (static_cast<size_t>(sy) * framebufferWidth + srcX0) * 4;
+                    for (uint32_t sx = srcX0; sx < srcX1; ++sx, row += 4)
+                    {
+                        sum[0] += row[0];
+                        sum[1] += row[1];
+                        sum[2] += row[2];
+                    }
+                }
+                const uint32_t count = (srcX1 - srcX0) * (srcY1 - srcY0);
+                // GL rows go bottom-up, thumbnails are stored top-down.
+                uint8_t* dst = header.thumbnail + ((dstHeight - 1 - y) * dstWidth + x) * 4;
+                dst[0] = static_cast<uint8_t>(sum[0] / count);
+                dst[1] = static_cast<uint8_t>(sum[1] / count);
+                dst[2] = static_cast<uint8_t>(sum[2] / count);
+                dst[3] = 255;
+            }
+        }
+        header.hasThumbnail = 1;
+    }
+
+    SaveHeaderCache::~SaveHeaderCache()
+    {
+        Clear();
+    }
+
+    const SaveHeader* SaveHeaderCache::Get(const std::filesystem::path& save)
+    {
+        return Load(save).header.get();
+    }
+
+    uint32_t SaveHeaderCache::GetThumbnail(const std::filesystem::path& save)
+    {
+        auto& entry = Load(save);
+        if (entry.texture || !entry.header || !entry.header->hasThumbnail)
+            return entry.texture;
+
+        int prevTexture{};
+        gl::GetIntegerv(gl::TEXTURE_BINDING_2D, &prevTexture);
+        gl::GenTextures(1, &entry.texture);
+        gl::BindTexture(gl::TEXTURE_2D, entry.texture);
+        gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MIN_FILTER, gl::LINEAR);
+        gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::LINEAR);
+        gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_WRAP_S, gl::CLAMP_TO_EDGE);
+        gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_WRAP_T, gl::CLAMP_TO_EDGE);
+        gl::PixelStorei(gl::UNPACK_ALIGNMENT, 1);
+        gl::TexImage2D(gl::TEXTURE_2D, 0, gl::RGBA8, SaveHeader::THUMBNAIL_WIDTH, SaveHeader::THUMBNAIL_HEIGHT, 0, gl::RGBA,
+                       gl::UNSIGNED_BYTE, entry.header->thumbnail);
+        gl::BindTexture(gl::TEXTURE_2D, prevTexture);
+        return entry.texture;
+    }
+
+    void SaveHeaderCache::Refresh(const std::vector<std::filesystem::path>& saves)
+    {
+        std::unordered_map<std::string, Entry> entries{};
+        for (const auto& save : saves)
+        {
+            const auto it = mEntries.find(save.string());
+            if (it == mEntries.end())
+                continue;
+            std::error_code error{};
+            const auto writeTime = std::filesystem::last_write_time(GetSaveHeaderPath(save), error);
+            if (!error && writeTime == it->second.writeTime)
+            {
+                entries.emplace(it->first, std::move(it->second));
+                it->second.texture = 0;
+            }
+        }
+        Clear();
+        mEntries = std::move(entries);
+    }
+
+    void SaveHeaderCache::Invalidate(const std::filesystem::path& save)
+    {
+        const auto it = mEntries.find(save.string());
+        if (it == mEntries.end())
+            return;
+        DestroyTexture(it->second);
+        mEntries.erase(it);
+    }
+
+    void SaveHeaderCache::Clear()
+    {
+        for (auto& [path, entry] : mEntries)
+            DestroyTexture(entry);
+        mEntries.clear();
+    }
+
+    SaveHeaderCache::Entry& SaveHeaderCache::Load(const std::filesystem::path& save)
+    {
+        auto& entry = mEntries[save.string()];
+        if (entry.isLoaded)
+            return entry;
+
+        entry.isLoaded = true;
+        auto header = std::make_unique<SaveHeader>();
+        if (ReadSaveHeader(save, *header))
+        {
+            std::error_code error{};
+            entry.writeTime = std::filesystem::last_write_time(GetSaveHeaderPath(save), error);
+            entry.header = std::move(header);
+        }
+        return entry;
+    }
+
+    void SaveHeaderCache::DestroyTexture(Entry& entry)
+    {
+        if (entry.texture)
+            gl::DeleteTextures(1, &entry.texture);
+        entry.texture = 0;
+    }
+} // namespace TSOCA
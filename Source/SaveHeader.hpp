@@ -0,0 +1,79 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace TSOCA
+{
+    // Fixed-size description of a save, stored next to the engine's world dump so the
+    // saves menu never has to deserialize a world just to show what is inside.
+    struct SaveHeader
+    {
+        static constexpr uint32_t MAGIC{0x4D454F54}; // "TOEM"
+        static constexpr uint32_t VERSION{1};
+        static constexpr uint32_t THUMBNAIL_WIDTH{160};
+        static constexpr uint32_t THUMBNAIL_HEIGHT{90};
+        static constexpr uint32_t THUMBNAIL_SIZE{THUMBNAIL_WIDTH * THUMBNAIL_HEIGHT * 4};
+
+        uint32_t magic{MAGIC};
+        uint32_t version{VERSION};
+        int64_t timestamp{};
+        uint32_t iterator{};
+        uint32_t hasThumbnail{};
+        char label[32]{};
+        char lastLine[256]{};
+        uint8_t thumbnail[THUMBNAIL_SIZE]{};
+
+        [[nodiscard]] bool IsValid() const;
+    };
+    static_assert(std::is_trivially_copyable_v<SaveHeader>);
+
+    std::filesystem::path GetSaveHeaderPath(const std::filesystem::path& save);
+    bool WriteSaveHeader(const std::filesystem::path& save, const SaveHeader& header);
+    bool ReadSaveHeader(const std::filesystem::path& save, SaveHeader& header);
+
+    // Box-filters a captured frame (bottom-up RGBA8 rows) into the thumbnail.
+    void FillThumbnail(SaveHeader& header, const std::vector<uint8_t>& pixels, int framebufferWidth, int framebufferHeight);
+
+    class SaveHeaderCache
+    {
+      public:
+        SaveHeaderCache() = default;
+        SaveHeaderCache(const SaveHeaderCache&) = delete;
+        SaveHeaderCache& operator=(const SaveHeaderCache&) = delete;
+        ~SaveHeaderCache();
+
+        // Returns nullptr for saves without a header (e.g. made by older builds).
+        const SaveHeader* Get(const std::filesystem::path& save);
+        uint32_t GetThumbnail(const std::filesystem::path& save);
+
+        // Drops entries whose files changed or vanished; call when the saves list is rebuilt.
+        void Refresh(const std::vector<std::filesystem::path>& saves);
+        void Invalidate(const std::filesystem::path& save);
+        void Clear();
+
+      private:
+        struct Entry
+        {
+            std::filesystem::file_time_type writeTime{};
+            std::unique_ptr<SaveHeader> header{};
+            uint32_t texture{};
+            bool isLoaded{};
+        };
+
+        Entry& Load(const std::filesystem::path& save);
+        static void DestroyTexture(Entry& entry);
+
+        std::unordered_map<std::string, Entry> mEntries{};
+    };
+} // namespace TSOCA
@@ -0,0 +1,312 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "ScriptAnalyzer.hpp"
+#include "Oneiro/Lua/LuaCharacter.hpp"
+#include "Oneiro/Lua/LuaTextBox.hpp"
+#include "Oneiro/Renderer/Renderer.hpp"
+#include "Oneiro/VisualNovel/VNCore.hpp"
+#include "Oneiro/World/World.hpp"
+#include "yaml-cpp/yaml.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <unordered_map>
+
+namespace TSOCA
+{
+    namespace
+    {
+        constexpr uint32_t NO_RESOURCE{UINT32_MAX};
+        // HazelAudio decodes whole files into 16-bit buffers; the sample format is not exposed, so CD format is assumed.
+        constexpr uint64_t AUDIO_BYTES_PER_SECOND{44100 * 2 * 2};
+
+        template <class T> uint64_t GetTextureBytes(const T& data)
+        {
+            return static_cast<uint64_t>(data->Width) * data->Height * std::max<uint64_t>(data->Channels, 1);
+        }
+
+        template <class T> uint64_t GetCharacterBytes(const T& character, const std::string& emotion)
+        {
+            using namespace oe;
+            if constexpr (requires { character.GetSprite(emotion)->GetTexture()->GetData(); })
+                return GetTextureBytes(character.GetSprite(emotion)->GetTexture()->GetData());
+            else if constexpr (requires { character.GetEntity(emotion).template GetComponent<Sprite2DComponent>(); })
+            {
+                const auto& entity = character.GetEntity(emotion);
+                if (!entity.template HasComponent<Sprite2DComponent>())
+                    return 0;
+                return GetTextureBytes(entity.template GetComponent<Sprite2DComponent>().Sprite2D->GetTexture()->GetData());
+            }
+            else
+                return 0;
+        }
+
+        template <class T> uint64_t GetAudioBytes(const T& source)
+        {
+            if constexpr (requires { source.GetLengthMinutesAndSeconds(); })
+            {
+                const auto [minutes, seconds] = source.GetLengthMinutesAndSeconds();
+                return (static_cast<uint64_t>(minutes) * 60 + seconds) * AUDIO_BYTES_PER_SECOND;
+            }
+            else
+                return 0;
+        }
+
+        const char* GetResourceTypeName(ScriptResourceType type)
+        {
+            switch (type)
+            {
+            case TEXTURE_RESOURCE: return "Texture";
+            case CHARACTER_RESOURCE: return "Character";
+            case AUDIO_RESOURCE: return "Audio";
+            case SHADER_RESOURCE: return "Shader";
+            case TEXTBOX_RESOURCE: return "TextBox";
+            }
+            return "";
+        }
+
+        class ResidentSet
+        {
+          public:
+            explicit ResidentSet(const std::vector<ScriptResource>& resources) : mResources(&resources)
+            {
+            }
+
+            void Collect(std::set<uint32_t>& out) const
+            {
+                for (const auto index : {mBackground, mPrevBackground, mTextBox, mShader})
+                {
+                    if (index != NO_RESOURCE)
+                        out.insert(index);
+                }
+                for (const auto& [name, index] : mCharacters)
+                    out.insert(index);
+                out.insert(mAudio.begin(), mAudio.end());
+            }
+
+            [[nodiscard]] uint64_t GetBytes() const
+            {
+                std::set<uint32_t> resident{};
+                Collect(resident);
+                uint64_t bytes{};
+                for (const auto index : resident)
+                    bytes += (*mResources)[index].bytes;
+                return bytes;
+            }
+
+            uint32_t mBackground{NO_RESOURCE};
+            uint32_t mPrevBackground{NO_RESOURCE};
+            uint32_t mTextBox{NO_RESOURCE};
+            uint32_t mShader{NO_RESOURCE};
+            std::map<std::string, uint32_t> mCharacters{};
+            std::set<uint32_t> mAudio{};
+
+          private:
+            const std::vector<ScriptResource>* mResources{};
+        };
+    } // namespace
+
+    const ScriptRange* ScriptAnalysis::FindRange(uint32_t iterator) const
+    {
+        const auto it = std::upper_bound(ranges.begin(), ranges.end(), iterator,
+                                         [](uint32_t value, const ScriptRange& range) { return value < range.end; });
+        return it != ranges.end() && it->begin <= iterator ? &*it : nullptr;
+    }
+
+    std::vector<uint32_t> ScriptAnalysis::CollectResources(uint32_t begin, uint32_t end) const
+    {
+        std::vector<uint32_t> result{};
+        end = std::min(end, static_cast<uint32_t>(instructionResources.size()));
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const auto index = instructionResources[i];
+            if (index >= 0 && std::find(result.begin(), result.end(), static_cast<uint32_t>(index)) == result.end())
+                result.push_back(static_cast<uint32_t>(index));
+        }
+        return result;
+    }
+
+    ScriptAnalysis AnalyzeScript(const std::string& startLabel)
+    {
+        using namespace oe;
+        using namespace Renderer;
+
+        ScriptAnalysis analysis{};
+        std::unordered_map<std::string, uint32_t> resourceIndices{};
+        std::unordered_map<const void*, uint32_t> audioIndices{};
+        const auto getResource = [&](ScriptResourceType type, const std::string& name, uint64_t bytes) {
+            const auto key = std::to_string(type) + ':' + name;
+            const auto [it, isInserted] = resourceIndices.try_emplace(key, static_cast<uint32_t>(analysis.resources.size()));
+            if (isInserted)
+                analysis.resources.push_back({type, name, bytes});
+            return it->second;
+        };
+
+        const auto& instructions = VisualNovel::GetInstructions();
+        analysis.instructionResources.assign(instructions.size(), -1);
+
+        ResidentSet resident{analysis.resources};
+        // Labels follow each other in the instructions, but each is entered from the last choice menu.
+        std::optional<ResidentSet> branchPoint{};
+        ScriptRange range{startLabel};
+        std::set<uint32_t> rangeResources{};
+        const auto closeRange = [&](uint32_t end) {
+            range.end = end;
+            resident.Collect(rangeResources);
+            range.resources.assign(rangeResources.begin(), rangeResources.end());
+            if (range.end > range.begin)
+                analysis.ranges.push_back(range);
+            range = {range.label, end};
+            rangeResources.clear();
+        };
+
+        for (uint32_t i{}; i < instructions.size(); ++i)
+        {
+            const auto& instruction = instructions[i];
+            uint32_t resource{NO_RESOURCE};
+            switch (instruction.type)
+            {
+            case VisualNovel::CHANGE_SCENE: {
+                closeRange(i);
+                resident.mPrevBackground = resident.mBackground;
+                resident.mBackground = NO_RESOURCE;
+                if (instruction.sceneEntity.HasComponent<Sprite2DComponent>())
+                {
+                    const auto& data = instruction.sceneEntity.GetComponent<Sprite2DComponent>().Sprite2D->GetTexture()->GetData();
+                    resource = getResource(TEXTURE_RESOURCE, data->Path, GetTextureBytes(data));
+                    resident.mBackground = resource;
+                }
+                break;
+            }
+            case VisualNovel::SHOW_CHARACTER: {
+                const auto& character = *instruction.characterData.character;
+                const auto& name = character.GetName();
+                resource = getResource(CHARACTER_RESOURCE, name + ':' + instruction.characterData.emotion,
+                                       GetCharacterBytes(character, instruction.characterData.emotion));
+                resident.mCharacters[name] = resource;
+                break;
+            }
+            case VisualNovel::HIDE_CHARACTER: resident.mCharacters.erase(instruction.characterData.character->GetName()); break;
+            case VisualNovel::PLAY_MUSIC:
+            case VisualNovel::PLAY_SOUND:
+            case VisualNovel::PLAY_AMBIENT: {
+                const auto [it, isInserted] =
+                    audioIndices.try_emplace(instruction.audioSource, static_cast<uint32_t>(audioIndices.size()));
+                resource = getResource(AUDIO_RESOURCE, "audio#" + std::to_string(it->second),
+                                       instruction.audioSource ? GetAudioBytes(*instruction.audioSource) : 0);
+                resident.mAudio.insert(resource);
+                break;
+            }
+            case VisualNovel::STOP_MUSIC:
+            case VisualNovel::STOP_SOUND:
+            case VisualNovel::STOP_AMBIENT: {
+                const auto it = audioIndices.find(instruction.audioSource);
+                if (it != audioIndices.end())
+                    resident.mAudio.erase(getResource(AUDIO_RESOURCE, "audio#" + std::to_string(it->second), 0));
+                break;
+            }
+            case VisualNovel::CHANGE_TEXTBOX: {
+                const auto& data = instruction.textBox->GetSprite()->GetTexture()->GetData();
+                resource = getResource(TEXTBOX_RESOURCE, data->Path, GetTextureBytes(data));
+                resident.mTextBox = resource;
+                break;
+            }
+            case VisualNovel::LOAD_FRAMEBUFFER_SHADER: {
+                std::error_code error{};
+                const auto bytes = std::filesystem::file_size(instruction.target, error);
+                resource = getResource(SHADER_RESOURCE, instruction.target, error ? 0 : bytes);
+                resident.mShader = resource;
+                break;
+            }
+            case VisualNovel::JUMP_TO_LABEL:
+                closeRange(i + 1);
+                range.label = instruction.label.name;
+                if (branchPoint)
+                    resident = *branchPoint;
+                break;
+            case VisualNovel::CHOICE_MENU:
+                closeRange(i + 1);
+                branchPoint = resident;
+                break;
+            default: break;
+            }
+
+            if (resource != NO_RESOURCE)
+            {
+                analysis.instructionResources[i] = static_cast<int32_t>(resource);
+                rangeResources.insert(resource);
+            }
+
+            const auto bytes = resident.GetBytes();
+            range.peakBytes = std::max(range.peakBytes, bytes);
+            if (bytes > analysis.peakBytes)
+            {
+                analysis.peakBytes = bytes;
+                analysis.peakIterator = i;
+            }
+
+            // The previous background only stays for the dissolve into the next one.
+            if (instruction.type != VisualNovel::CHANGE_SCENE)
+                resident.mPrevBackground = NO_RESOURCE;
+        }
+        closeRange(static_cast<uint32_t>(instructions.size()));
+        return analysis;
+    }
+
+    bool WriteScriptAnalysis(const ScriptAnalysis& analysis, const std::filesystem::path& path, uint64_t memoryBudget)
+    {
+        std::ofstream file{path};
+        if (!file.is_open())
+            return false;
+
+        YAML::Emitter out{};
+        out << YAML::BeginMap; // Begin Root
+        out << YAML::Key << "ScriptAnalysis";
+        out << YAML::BeginMap; // Begin ScriptAnalysis
+        out << YAML::Key << "Instructions" << YAML::Value << analysis.instructionResources.size();
+        out << YAML::Key << "PeakBytes" << YAML::Value << analysis.peakBytes;
+        out << YAML::Key << "PeakIterator" << YAML::Value << analysis.peakIterator;
+        if (memoryBudget)
+        {
+            out << YAML::Key << "MemoryBudget" << YAML::Value << memoryBudget;
+            out << YAML::Key << "IsWithinBudget" << YAML::Value << (analysis.peakBytes <= memoryBudget);
+        }
+
+        out << YAML::Key << "Resources";
+        out << YAML::BeginSeq; // Begin Resources
+        for (const auto& resource : analysis.resources)
+        {
+            out << YAML::Flow << YAML::BeginMap;
+            out << YAML::Key << "Type" << YAML::Value << GetResourceTypeName(resource.type);
+            out << YAML::Key << "Name" << YAML::Value << resource.name;
+            out << YAML::Key << "Bytes" << YAML::Value << resource.bytes;
+            out << YAML::EndMap;
+        }
+        out << YAML::EndSeq; // End Resources
+
+        out << YAML::Key << "Ranges";
+        out << YAML::BeginSeq; // Begin Ranges
+        for (const auto& range : analysis.ranges)
+        {
+            out << YAML::BeginMap; // Begin Range
+            out << YAML::Key << "Label" << YAML::Value << range.label;
+            out << YAML::Key << "Begin" << YAML::Value << range.begin;
+            out << YAML::Key << "End" << YAML::Value << range.end;
+            out << YAML::Key << "PeakBytes" << YAML::Value << range.peakBytes;
+            out << YAML::Key << "Resources" << YAML::Value << YAML::Flow << range.resources;
+            out << YAML::EndMap; // End Range
+        }
+        out << YAML::EndSeq; // End Ranges
+
+        out << YAML::EndMap; // End ScriptAnalysis
+        out << YAML::EndMap; // End Root
+
+        file << out.c_str();
+        return true;
+    }
+} // namespace TSOCA
@@ -0,0 +1,62 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace TSOCA
+{
+    enum ScriptResourceType : uint8_t
+    {
+        TEXTURE_RESOURCE,
+        CHARACTER_RESOURCE,
+        AUDIO_RESOURCE,
+        SHADER_RESOURCE,
+        TEXTBOX_RESOURCE
+    };
+
+    struct ScriptResource
+    {
+        ScriptResourceType type{};
+        std::string name{};
+        // Decoded size: RGBA texels for textures, 16-bit stereo PCM for audio. Zero only when this
+        // engine build exposes neither the character sprite nor the audio length.
+        uint64_t bytes{};
+    };
+
+    // A run of instructions between two scene changes or label jumps.
+    struct ScriptRange
+    {
+        std::string label{};
+        uint32_t begin{};
+        uint32_t end{};
+        // Indices into ScriptAnalysis::resources that are resident somewhere inside the range.
+        std::vector<uint32_t> resources{};
+        uint64_t peakBytes{};
+    };
+
+    struct ScriptAnalysis
+    {
+        std::vector<ScriptResource> resources{};
+        std::vector<ScriptRange> ranges{};
+        // Resource referenced by each instruction, or -1.
+        std::vector<int32_t> instructionResources{};
+        uint64_t peakBytes{};
+        uint32_t peakIterator{};
+
+        [[nodiscard]] const ScriptRange* FindRange(uint32_t iterator) const;
+        // Resources needed by instructions in [begin, end).
+        [[nodiscard]] std::vector<uint32_t> CollectResources(uint32_t begin, uint32_t end) const;
+    };
+
+    // Walks VisualNovel::GetInstructions() and simulates which resources are resident. Every
+    // branch of a choice menu starts from the resources resident at the menu.
+    ScriptAnalysis AnalyzeScript(const std::string& startLabel = "start");
+    bool WriteScriptAnalysis(const ScriptAnalysis& analysis, const std::filesystem::path& path, uint64_t memoryBudget = 0);
+} // namespace TSOCA
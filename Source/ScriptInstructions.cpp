@@ -0,0 +1,189 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "ScriptInstructions.hpp"
+#include "Oneiro/Lua/LuaCharacter.hpp"
+#include "Oneiro/Lua/LuaTextBox.hpp"
+#include "Oneiro/Renderer/Renderer.hpp"
+#include "Oneiro/World/World.hpp"
+#include "TextUtils.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <string_view>
+
+namespace TSOCA
+{
+    namespace
+    {
+        template <typename... Args>
+        void Append(FrameString& out, const Args&... parts)
+        {
+            (out.append(std::string_view{parts}), ...);
+        }
+
+        // Same output as std::to_string(float) without the temporary.
+        void AppendFloat(FrameString& out, float value)
+        {
+            char buffer[32]{};
+            const int size = std::snprintf(buffer, sizeof(buffer), "%f", value);
+            out.append(buffer, size > 0 ? static_cast<size_t>(size) : 0);
+        }
+
+        void Mix(uint32_t& hash, uint32_t value)
+        {
+            hash = (hash ^ value) * 16777619u;
+        }
+    } // namespace
+
+    bool IsAudioInstruction(const ScriptInstruction& instruction)
+    {
+        using namespace oe;
+        switch (instruction.type)
+        {
+        case VisualNovel::PLAY_MUSIC:
+        case VisualNovel::STOP_MUSIC:
+        case VisualNovel::PLAY_SOUND:
+        case VisualNovel::STOP_SOUND:
+        case VisualNovel::PLAY_AMBIENT:
+        case VisualNovel::STOP_AMBIENT: return instruction.audioSource != nullptr;
+        default: return false;
+        }
+    }
+
+    FrameString GetInstructionTitle(const ScriptInstruction& instruction, std::pmr::memory_resource* resource)
+    {
+        using namespace oe;
+        FrameString title{resource};
+        const auto characterTitle = [&](const char* action) {
+            Append(title, action, instruction.characterData.character->GetName(), ":", instruction.characterData.emotion);
+        };
+        switch (instruction.type)
+        {
+        case VisualNovel::CHANGE_SCENE: Append(title, "Change Scene | ", instruction.sceneEntity.GetComponent<TagComponent>().Tag); break;
+        case VisualNovel::SHOW_CHARACTER: characterTitle("Show Character | "); break;
+        case VisualNovel::HIDE_CHARACTER: characterTitle("Hide Character | "); break;
+        case VisualNovel::MOVE_CHARACTER: characterTitle("Move Sprite | "); break;
+        case VisualNovel::PLAY_MUSIC: Append(title, "Play Music"); break;
+        case VisualNovel::STOP_MUSIC: Append(title, "Stop Music"); break;
+        case VisualNovel::PLAY_SOUND: Append(title, "Play Sound"); break;
+        case VisualNovel::STOP_SOUND: Append(title, "Stop Sound"); break;
+        case VisualNovel::PLAY_AMBIENT: Append(title, "Play Ambient"); break;
+        case VisualNovel::STOP_AMBIENT: Append(title, "Stop Ambient"); break;
+        case VisualNovel::JUMP_TO_LABEL: Append(title, "Jump To Label | ", instruction.label.name); break;
+        case VisualNovel::SAY_TEXT:
+            Append(title, "Say Text | ", instruction.characterData.character->GetName(), ": ", instruction.characterData.text);
+            break;
+        case VisualNovel::CHOICE_MENU: {
+            Append(title, "Choice Menu | ");
+            const auto& items = instruction.choiceMenuItems;
+            for (size_t i{}; i < items.size(); ++i)
+                Append(title, i % 2 ? "target = " : "var = ", items[i], "; ");
+            break;
+        }
+        case VisualNovel::SHOW_TEXTBOX:
+            Append(title, "Show Text Box | ");
+            AppendFloat(title, instruction.animationSpeed);
+            break;
+        case VisualNovel::HIDE_TEXTBOX:
+            Append(title, "Hide Text Box | ");
+            AppendFloat(title, instruction.animationSpeed);
+            break;
+        case VisualNovel::WAIT:
+            Append(title, "Wait | ");
+            AppendFloat(title, instruction.animationSpeed);
+            Append(title, " / ", std::string(instruction.target));
+            break;
+        case VisualNovel::CHANGE_TEXTBOX:
+            Append(title, "Change Text Box | ", instruction.textBox->GetSprite()->GetTexture()->GetData()->Path);
+            break;
+        case VisualNovel::LOAD_FRAMEBUFFER_SHADER: Append(title, "Load FrameBuffer Shader | ", instruction.target); break;
+        default: break;
+        }
+        return title;
+    }
+
+    FrameString GetSayText(const ScriptInstruction& instruction, std::pmr::memory_resource* resource)
+    {
+        const auto& name = instruction.characterData.character->GetName();
+        const std::string_view text{instruction.characterData.text};
+
+        FrameString result{resource};
+        result.reserve(name.size() + text.size() + 2);
+        if (!name.empty())
+        {
+            AppendStrippedMarkup(name, result);
+            result += ": ";
+        }
+        AppendStrippedMarkup(text, result);
+        return result;
+    }
+
+    uint32_t GetInstructionFingerprint(const ScriptInstruction& instruction)
+    {
+        using namespace oe;
+        uint32_t hash{2166136261u};
+        Mix(hash, static_cast<uint32_t>(instruction.type));
+        switch (instruction.type)
+        {
+        case VisualNovel::CHANGE_SCENE: Mix(hash, HashString(instruction.sceneEntity.GetComponent<TagComponent>().Tag)); break;
+        case VisualNovel::SHOW_CHARACTER:
+        case VisualNovel::HIDE_CHARACTER:
+        case VisualNovel::MOVE_CHARACTER:
+            Mix(hash, HashString(instruction.characterData.character->GetName()));
+            Mix(hash, HashString(instruction.characterData.emotion));
+            break;
+        case VisualNovel::JUMP_TO_LABEL: Mix(hash, HashString(instruction.label.name)); break;
+        case VisualNovel::SAY_TEXT:
+            Mix(hash, HashString(instruction.characterData.character->GetName()));
+            Mix(hash, HashString(instruction.characterData.text));
+            break;
+        case VisualNovel::CHOICE_MENU:
+            for (const auto& item : instruction.choiceMenuItems)
+                Mix(hash, HashString(item));
+            break;
+        case VisualNovel::SHOW_TEXTBOX:
+        case VisualNovel::HIDE_TEXTBOX: Mix(hash, std::bit_cast<uint32_t>(instruction.animationSpeed)); break;
+        case VisualNovel::WAIT:
+            Mix(hash, std::bit_cast<uint32_t>(instruction.animationSpeed));
+            Mix(hash, HashString(std::string(instruction.target)));
+            break;
+        case VisualNovel::CHANGE_TEXTBOX: Mix(hash, HashString(instruction.textBox->GetSprite()->GetTexture()->GetData()->Path)); break;
+        case VisualNovel::LOAD_FRAMEBUFFER_SHADER: Mix(hash, HashString(instruction.target)); break;
+        default: break;
+        }
+        return hash;
+    }
+
+    std::vector<uint32_t> CollectScriptFingerprints()
+    {
+        const auto& instructions = oe::VisualNovel::GetInstructions();
+        std::vector<uint32_t> fingerprints{};
+        fingerprints.reserve(instructions.size());
+        for (const auto& instruction : instructions)
+            fingerprints.push_back(GetInstructionFingerprint(instruction));
+        return fingerprints;
+    }
+
+    uint32_t MapScriptIterator(const std::vector<uint32_t>& from, const std::vector<uint32_t>& to, uint32_t iterator)
+    {
+        const auto fromSize = static_cast<uint32_t>(from.size());
+        const auto toSize = static_cast<uint32_t>(to.size());
+        const auto commonSize = std::min(fromSize, toSize);
+
+        uint32_t prefix{};
+        while (prefix < commonSize && from[prefix] == to[prefix])
+            prefix++;
+        uint32_t suffix{};
+        while (suffix < commonSize - prefix && from[fromSize - suffix - 1] == to[toSize - suffix - 1])
+            suffix++;
+
+        if (iterator <= prefix)
+            return iterator;
+        if (iterator >= fromSize - suffix)
+            return std::min(iterator - (fromSize - suffix) + (toSize - suffix), toSize);
+        return prefix;
+    }
+} // namespace TSOCA
@@ -0,0 +1,32 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "FrameArena.hpp"
+#include "Oneiro/VisualNovel/VNCore.hpp"
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace TSOCA
+{
+    using ScriptInstruction = std::decay_t<decltype(oe::VisualNovel::GetInstructions()[0])>;
+
+    [[nodiscard]] bool IsAudioInstruction(const ScriptInstruction& instruction);
+    [[nodiscard]] FrameString GetInstructionTitle(const ScriptInstruction& instruction,
+                                                  std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    // "Name: text" without markup, or just the text for the narrator.
+    [[nodiscard]] FrameString GetSayText(const ScriptInstruction& instruction,
+                                         std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Equal for instructions that do the same thing, used to diff the script across a reload.
+    [[nodiscard]] uint32_t GetInstructionFingerprint(const ScriptInstruction& instruction);
+    [[nodiscard]] std::vector<uint32_t> CollectScriptFingerprints();
+
+    // Maps an iterator in one version of the script to the equivalent position in another: unchanged prefixes and
+    // suffixes keep their place, a position inside the edited region moves to the first changed instruction.
+    uint32_t MapScriptIterator(const std::vector<uint32_t>& from, const std::vector<uint32_t>& to, uint32_t iterator);
+} // namespace TSOCA
@@ -0,0 +1,47 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "ScriptWatcher.hpp"
+
+namespace TSOCA
+{
+    ScriptWatcher::ScriptWatcher(std::vector<std::filesystem::path> files, float interval) : mInterval(interval)
+    {
+        for (auto& file : files)
+            mFiles.push_back({std::move(file)});
+        Reset();
+    }
+
+    std::vector<std::filesystem::path> ScriptWatcher::Poll(float deltaTime)
+    {
+        std::vector<std::filesystem::path> changed{};
+        mElapsed += deltaTime;
+        if (mElapsed < mInterval)
+            return changed;
+        mElapsed = 0.0f;
+
+        for (auto& file : mFiles)
+        {
+            std::error_code error{};
+            const auto writeTime = std::filesystem::last_write_time(file.path, error);
+            // Editors often replace the file, so a missing file is just skipped until it is back.
+            if (error || writeTime == file.writeTime)
+                continue;
+            file.writeTime = writeTime;
+            changed.push_back(file.path);
+        }
+        return changed;
+    }
+
+    void ScriptWatcher::Reset()
+    {
+        for (auto& file : mFiles)
+        {
+            std::error_code error{};
+            file.writeTime = std::filesystem::last_write_time(file.path, error);
+        }
+        mElapsed = 0.0f;
+    }
+} // namespace TSOCA
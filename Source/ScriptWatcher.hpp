@@ -0,0 +1,35 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+namespace TSOCA
+{
+    // Polls modification times of the script files; cheap enough to run every frame.
+    class ScriptWatcher
+    {
+      public:
+        explicit ScriptWatcher(std::vector<std::filesystem::path> files, float interval = 0.5f);
+
+        // Returns the files changed since the last poll; empty between intervals.
+        std::vector<std::filesystem::path> Poll(float deltaTime);
+        // Forgets pending changes, e.g. after the scripts were reloaded another way.
+        void Reset();
+
+      private:
+        struct WatchedFile
+        {
+            std::filesystem::path path{};
+            std::filesystem::file_time_type writeTime{};
+        };
+
+        std::vector<WatchedFile> mFiles{};
+        float mInterval{};
+        float mElapsed{};
+    };
+} // namespace TSOCA
@@ -0,0 +1,123 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "StringTable.hpp"
+#include "Oneiro/Lua/LuaCharacter.hpp"
+#include "Oneiro/Runtime/Engine.hpp"
+#include "Oneiro/VisualNovel/VNCore.hpp"
+#include "TextUtils.hpp"
+#include "yaml-cpp/yaml.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+namespace TSOCA
+{
+    namespace
+    {
+        struct Header
+        {
+            uint32_t magic{};
+            uint32_t version{};
+            uint32_t count{};
+            uint32_t reserved{};
+        };
+
+        struct Entry
+        {
+            uint32_t key{};
+            uint32_t offset{};
+            uint32_t size{};
+        };
+
+        constexpr uint32_t MAGIC{0x54535354}; // "TSST"
+        constexpr uint32_t VERSION{1};
+
+        void WarnHashCollision(uint32_t key, const std::string& lhs, const std::string& rhs)
+        {
+            OE_LOG_WARNING("Lines '" + lhs + "' and '" + rhs + "' share the string key " + std::to_string(key) + "!");
+        }
+    } // namespace
+
+    bool WriteStringTable(const std::filesystem::path& path, std::vector<std::pair<uint32_t, std::string>> entries)
+    {
+        std::stable_sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+        // Repeated lines collapse into one entry; different lines under one key would make the table ambiguous.
+        const auto collision = std::adjacent_find(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.first == rhs.first && lhs.second != rhs.second;
+        });
+        if (collision != entries.end())
+        {
+            WarnHashCollision(collision->first, collision->second, std::next(collision)->second);
+            return false;
+        }
+        entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+        std::vector<Entry> index{};
+        index.reserve(entries.size());
+        std::string blob{};
+        for (const auto& [key, text] : entries)
+        {
+            index.push_back({key, static_cast<uint32_t>(blob.size()), static_cast<uint32_t>(text.size())});
+            blob += text;
+        }
+
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        if (!file.is_open())
+            return false;
+        const Header header{MAGIC, VERSION, static_cast<uint32_t>(index.size())};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(Entry)));
+        file.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+        return file.good();
+    }
+
+    bool ExportScriptStrings(const std::filesystem::path& path)
+    {
+        std::unordered_map<uint32_t, const std::string*> lines{};
+        YAML::Emitter out{};
+        out << YAML::BeginMap; // Begin Strings
+        for (const auto& instruction : oe::VisualNovel::GetInstructions())
+        {
+            if (!instruction.EqualType(oe::VisualNovel::SAY_TEXT))
+                continue;
+            const auto& text = instruction.characterData.text;
+            const auto key = HashString(text);
+            if (const auto [it, isInserted] = lines.emplace(key, &text); !isInserted)
+            {
+                if (*it->second == text)
+                    continue;
+                WarnHashCollision(key, *it->second, text);
+                return false;
+            }
+            if (const auto& name = instruction.characterData.character->GetName(); !name.empty())
+                out << YAML::Comment(name);
+            out << YAML::Key << key << YAML::Value << text;
+        }
+        out << YAML::EndMap; // End Strings
+
+        std::ofstream file{path};
+        if (!file.is_open())
+            return false;
+        file << out.c_str();
+        return file.good();
+    }
+
+    bool CompileStringTable(const std::filesystem::path& source, const std::filesystem::path& output)
+    {
+        if (!std::filesystem::exists(source))
+            return false;
+        const auto strings = YAML::LoadFile(source.string());
+        if (!strings.IsMap())
+            return false;
+
+        std::vector<std::pair<uint32_t, std::string>> entries{};
+        entries.reserve(strings.size());
+        for (const auto& string : strings)
+            entries.emplace_back(string.first.as<uint32_t>(), string.second.as<std::string>());
+        return WriteStringTable(output, std::move(entries));
+    }
+} // namespace TSOCA
@@ -0,0 +1,23 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace TSOCA
+{
+    // A .oestrings table translates the script's say lines, keyed by HashString() of the line. The file is a header,
+    // entries sorted by key and a UTF-8 blob, so a memory-mapped lookup only touches the pages it reads.
+    // Fails when two different lines share a key.
+    bool WriteStringTable(const std::filesystem::path& path, std::vector<std::pair<uint32_t, std::string>> entries);
+    // Writes every say line of the loaded script as "hash: text" for translators; CompileStringTable() turns such a file into a table.
+    bool ExportScriptStrings(const std::filesystem::path& path);
+    bool CompileStringTable(const std::filesystem::path& source, const std::filesystem::path& output);
+} // namespace TSOCA
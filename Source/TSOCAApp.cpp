@@ -4,6 +4,8 @@
 //
 
 #include "TSOCAApp.hpp"
+#include "CompactSave.hpp"
+#include "FrameCapture.hpp"
 #include "Oneiro/Animation/DissolveAnimation.hpp"
 #include "Oneiro/Core/Random.hpp"
 #include "Oneiro/Lua/LuaCharacter.hpp"
@@ -13,9 +15,18 @@
 #include "Oneiro/Renderer/Renderer.hpp"
 #include "Oneiro/Runtime/Engine.hpp"
 #include "Oneiro/VisualNovel/VNCore.hpp"
+#include "ScriptInstructions.hpp"
+#include "StringTable.hpp"
+#include "TextUtils.hpp"
 #include "yaml-cpp/node/parse.h"
 #include "yaml-cpp/yaml.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
 #include <string>
+#include <string_view>
 
 namespace oe::Renderer::GuiLayer
 {
@@ -63,10 +74,17 @@ namespace oe::Renderer::GuiLayer
         static uint32_t selected{};
         if (GuiLayer::BeginPopupModal(id.c_str(), nullptr, flags))
         {
-            auto localSaves = saves;
+            // Only copy the list when a filter needs to modify it.
+            std::vector<std::filesystem::path> filteredSaves{};
             if (saveFilesFunc)
-                saveFilesFunc(localSaves);
-            if (GuiLayer::BeginCombo("##localSaves", localSaves[selected].string().c_str()))
+            {
+                filteredSaves = saves;
+                saveFilesFunc(filteredSaves);
+            }
+            const auto& localSaves = saveFilesFunc ? filteredSaves : saves;
+            if (selected >= localSaves.size())
+                selected = 0;
+            if (!localSaves.empty() && GuiLayer::BeginCombo("##localSaves", localSaves[selected].string().c_str()))
             {
                 for (uint32_t i{}; i < localSaves.size(); ++i)
                 {
@@ -99,76 +117,213 @@ namespace oe::Renderer::GuiLayer
 
 namespace TSOCA
 {
+    namespace
+    {
+        // oe::Lua::File wraps a sol::state; nullptr when its state can't be reached.
+        template <class File> lua_State* GetLuaState(File& file)
+        {
+            if constexpr (requires { file.GetState().lua_state(); })
+                return file.GetState().lua_state();
+            else if constexpr (requires { static_cast<lua_State*>(file.GetState()); })
+                return static_cast<lua_State*>(file.GetState());
+            else
+                return nullptr;
+        }
+
+        constexpr const char* SAVE_SLOT_NAME{"player_save"};
+    } // namespace
+
     bool Application::OnPreInit()
     {
-        LoadGuiFont();
+        TraceRecorder::SetThreadName("Main");
+        if (!mLaunchOptions.traceOutput.empty())
+            TraceRecorder::Start(mLaunchOptions.traceOutput);
+
+        {
+            TraceScope fontScope{"LoadGuiFont", "Load"};
+            LoadGuiFont();
+        }
         SetupGuiStyle();
 
         if (!std::filesystem::exists("Saves/"))
             std::filesystem::create_directory("Saves");
 
-        InitScripts();
+        {
+            AllocationScopeGuard scriptsScope{SCRIPTS_SCOPE};
+            TraceScope scriptsTrace{"InitScripts", "Load"};
+            InitScripts();
+        }
 
-        if (mConfigData.IsFileExists())
+        // Tool runs use default settings, stay windowed and never show the main menu, so results are comparable.
+        const bool isToolRun = mLaunchOptions.IsToolRun();
+        if (mConfigData.IsFileExists() && !isToolRun)
             mConfigData.Load();
 
         SetMonitorFromConfig();
 
-        if (mConfigData.windowFullScreen)
+        if (mConfigData.windowFullScreen && !isToolRun)
             SetFullScreenFromConfig();
 
-        mMainMenuMusic.LoadFromFile("Assets/Audio/Music/main_theme.ogg");
-
+        if (!isToolRun)
+        {
+            AllocationScopeGuard audioScope{AUDIO_SCOPE};
+            TraceScope audioTrace{"LoadMainMenuMusic", "Load"};
+            mMainMenuMusic.LoadFromFile("Assets/Audio/Music/main_theme.ogg");
+        }
         Hazel::Audio::SetGlobalVolume(mConfigData.audioVolume);
+
         oe::VisualNovel::SetTextSpeed(mConfigData.textSpeed);
 
-        LoadWindowIcon();
+        {
+            TraceScope iconScope{"LoadWindowIcon", "Load"};
+            LoadWindowIcon();
+        }
 
-        SaveSpecifications();
+        if (!isToolRun)
+            SaveSpecifications();
 
         return true;
     }
 
     bool Application::OnInit()
     {
+        if (!mLaunchOptions.stringsExport.empty())
+        {
+            InitVisualNovel();
+            if (!ExportScriptStrings(mLaunchOptions.stringsExport))
+            {
+                OE_LOG_WARNING("Failed to export strings to '" + mLaunchOptions.stringsExport.string() + "'!");
+                mExitCode = EXIT_FAILURE;
+            }
+            Stop();
+            return true;
+        }
+
+        if (!mLaunchOptions.stringsSource.empty())
+        {
+            auto output = mLaunchOptions.stringsSource;
+            output.replace_extension(".oestrings");
+            if (!CompileStringTable(mLaunchOptions.stringsSource, output))
+            {
+                OE_LOG_WARNING("Failed to compile string table '" + mLaunchOptions.stringsSource.string() + "'!");
+                mExitCode = EXIT_FAILURE;
+            }
+            Stop();
+            return true;
+        }
+
+        if (!mLaunchOptions.scriptAnalysisOutput.empty())
+        {
+            InitVisualNovel();
+            const auto analysis = AnalyzeScript();
+            if (!WriteScriptAnalysis(analysis, mLaunchOptions.scriptAnalysisOutput, mLaunchOptions.memoryBudget))
+                OE_LOG_WARNING("Failed to write script analysis '" + mLaunchOptions.scriptAnalysisOutput.string() + "'!");
+            if (mLaunchOptions.memoryBudget && analysis.peakBytes > mLaunchOptions.memoryBudget)
+                OE_LOG_WARNING("Script peak resident set exceeds the memory budget!");
+            Stop();
+            return true;
+        }
+
+        if (mLaunchOptions.benchmark.isEnabled)
+        {
+            mBenchmark = std::make_unique<Benchmark>(mLaunchOptions.benchmark);
+            if (!mBenchmark->LoadReference())
+            {
+                mExitCode = EXIT_FAILURE;
+                mBenchmark.reset();
+                Stop();
+                return true;
+            }
+            Hazel::Audio::SetGlobalVolume(0.0f);
+            InitVisualNovel();
+            oe::Core::Root::GetWorld()->GetEntity("ParticleSystem").AddComponent<oe::ParticleSystemComponent>();
+            mIsStart = false;
+            return true;
+        }
         mMainMenuMusic.Play();
         return true;
     }
 
+    void Application::SetLaunchOptions(const LaunchOptions& options)
+    {
+        mLaunchOptions = options;
+        mIsHotReloadEnabled = options.isHotReloadEnabled;
+    }
+
     bool Application::OnUpdate(float deltaTime)
     {
         using namespace oe;
+        TraceScope frameScope{"Frame", "Frame"};
 
-        UpdateSettingsMenu(deltaTime);
+        if (mBenchmark)
+            deltaTime = mBenchmark->BeginFrame();
+
+        {
+            AllocationScopeGuard guiScope{GUI_SCOPE};
+            UpdateSettingsMenu(deltaTime);
+        }
 
         if (mIsStart)
         {
+            AllocationScopeGuard guiScope{GUI_SCOPE};
             UpdateMainMenu(deltaTime);
         }
         else
         {
+            if (mBenchmark && mBenchmark->Update(VisualNovel::GetCurrentIterator(), VisualNovel::IsRenderChoiceMenu()))
+                NextStep();
+
             if (!mShowEscapeMenu && mAutoNextStep)
             {
                 mAutoSkipTotalTime += deltaTime;
                 if (mAutoSkipTotalTime >= mConfigData.autoSkipTime)
                 {
-                    VisualNovel::NextStep();
+                    NextStep();
                     mAutoSkipTotalTime = 0.0f;
                 }
             }
 
-            Core::Root::GetWorld()->UpdateEntities();
-            VisualNovel::Update(deltaTime, !mShowEscapeMenu);
+            if (mIsHotReloadEnabled && !mIsReplaying)
+            {
+                if (const auto changed = mScriptWatcher.Poll(deltaTime); !changed.empty())
+                    ReloadScripts(changed);
+            }
 
-            UpdateSavesMenu(deltaTime);
-            UpdateHistoryMenu(deltaTime);
-            UpdateDebugInfo(deltaTime);
-            UpdateEscapeMenu(deltaTime);
+            if (mIsReplaying)
+            {
+                TraceScope replayScope{"UpdateReplay", "VN"};
+                UpdateReplay();
+            }
 
-            if (mShowDemoWindow)
-                Renderer::GuiLayer::ShowDemoWindow();
+            {
+                AllocationScopeGuard worldScope{WORLD_SCOPE};
+                TraceScope worldTrace{"World::UpdateEntities", "World"};
+                Core::Root::GetWorld()->UpdateEntities();
+            }
+            {
+                AllocationScopeGuard vnScope{VN_SCOPE};
+                TraceScope vnTrace{"VisualNovel::Update", "VN"};
+                VisualNovel::Update(deltaTime, !mShowEscapeMenu);
+                UpdateCurrentLabel();
+                mSearchIndex.Update();
+            }
 
-            ProcessVnWaiting(deltaTime);
+            {
+                AllocationScopeGuard guiScope{GUI_SCOPE};
+                TraceScope guiTrace{"GUI", "GUI"};
+                UpdateSavesMenu(deltaTime);
+                UpdateHistoryMenu(deltaTime);
+                UpdateDebugInfo(deltaTime);
+                UpdateEscapeMenu(deltaTime);
+
+                if (mShowDemoWindow)
+                    Renderer::GuiLayer::ShowDemoWindow();
+            }
+
+            {
+                TraceScope waitingScope{"ProcessVnWaiting", "VN"};
+                ProcessVnWaiting(deltaTime);
+            }
 
             if (!mAutoNextStep)
             {
@@ -179,7 +334,30 @@ namespace TSOCA
             }
         }
 
+        if (mBenchmark)
+        {
+            mBenchmark->EndFrame();
+            if (mBenchmark->IsFinished())
+            {
+                if (!mBenchmark->WriteReport() || !mBenchmark->IsMatchingReference())
+                    mExitCode = EXIT_FAILURE;
+                mBenchmark.reset();
+                Stop();
+            }
+        }
+
+        {
+            static constexpr float LUA_GC_BUDGET_MS{0.5f};
+            AllocationScopeGuard scriptsScope{SCRIPTS_SCOPE};
+            TraceScope gcScope{"LuaHeap::Step", "Scripts"};
+            mLuaHeap.Step(LUA_GC_BUDGET_MS);
+        }
+
+        mIoWorker.Poll();
+        ScheduleFrameCaptures();
         Renderer::ResetStats();
+        mFrameArena.Reset();
+        AllocationTracker::EndFrame();
 
         return true;
     }
@@ -192,7 +370,7 @@ namespace TSOCA
         {
             const auto& mouseButtonEvent = dynamic_cast<const Event::MouseButtonEvent&>(e);
             if (mouseButtonEvent.Button == Input::LEFT && mouseButtonEvent.Action == Input::PRESS && !mShowEscapeMenu)
-                VisualNovel::NextStep();
+                NextStep();
             return;
         }
 
@@ -204,15 +382,21 @@ namespace TSOCA
                 switch (keyInputEvent.Key)
                 {
                 case Input::D: mShowDebugInfoMenu = !mShowDebugInfoMenu; return;
-                case Input::S: mShowSavesMenu = !mShowSavesMenu && !mIsStart; return;
+                case Input::S: {
+                    if (!mShowSavesMenu && !mShowEscapeMenu && !mIsStart)
+                        CaptureSceneThumbnail();
+                    mShowSavesMenu = !mShowSavesMenu && !mIsStart;
+                    mIsSavesDirty = true;
+                    return;
+                }
                 case Input::H: mShowHistoryMenu = !mShowHistoryMenu && !mIsStart; return;
                 case Input::SPACE:
                     if (!mShowEscapeMenu)
-                        VisualNovel::NextStep();
+                        NextStep();
                     return;
                 case Input::ENTER:
                     if (!mShowEscapeMenu)
-                        VisualNovel::NextStep();
+                        NextStep();
                     return;
                 case Input::J: {
                     mAutoNextStep = !mAutoNextStep && !mIsStart && !mShowEscapeMenu;
@@ -221,7 +405,11 @@ namespace TSOCA
                 }
                 case Input::ESC: {
                     if (!mShowSettingsMenu && !mShowHistoryMenu && !mShowSavesMenu && !mIsStart && !mShowAcceptPopupModal)
+                    {
+                        if (!mShowEscapeMenu)
+                            CaptureSceneThumbnail();
                         mShowEscapeMenu = !mShowEscapeMenu;
+                    }
                     else
                     {
                         mShowSavesMenu = false;
@@ -243,10 +431,30 @@ namespace TSOCA
         auto particleSystemEntity = Core::Root::GetWorld()->GetEntity("ParticleSystem");
         if (particleSystemEntity.HasComponent<ParticleSystemComponent>())
             particleSystemEntity.GetComponent<ParticleSystemComponent>().DestroyParticleProps("main");
-        if (VisualNovel::GetCurrentLabel() == "start")
+        // A checkpoint write may still be in flight; the final one must not race it.
+        mIoWorker.Wait();
+        // Benchmark and analysis runs must not overwrite the player's autosave.
+        UpdateCurrentLabel();
+        if (mCurrentLabel == Atoms::Start() && !mLaunchOptions.IsToolRun())
+        {
+            if (!mIsStart && !mIsReplaying)
+            {
+                TraceScope compactScope{"Journal::Compact", "IO"};
+                mJournal.Compact(CaptureCompactSave());
+            }
             VisualNovel::Shutdown();
+        }
+        mJournal.Close();
+        // GL objects go while the context is still alive.
+        mSaveHeaders.Clear();
+        mBenchmark.reset();
         Core::Root::GetWorld()->DestroyEntity(particleSystemEntity);
-        mConfigData.Save();
+        if (!mLaunchOptions.IsToolRun())
+            mConfigData.Save();
+        if (TraceRecorder::IsRecording() && !TraceRecorder::Stop())
+            OE_LOG_WARNING("Failed to write trace!");
+        if (mExitCode != EXIT_SUCCESS)
+            std::exit(mExitCode);
     }
 
     void Application::UpdateMainMenu(float deltaTime)
@@ -265,17 +473,30 @@ namespace TSOCA
         {
             mMainMenuMusic.Stop();
             mMainMenuMusic.~Source();
-            oe::VisualNovel::Init(&mScriptFile, false);
+            InitVisualNovel();
+            mJournal.Open(false);
             oe::Core::Root::GetWorld()->GetEntity("ParticleSystem").AddComponent<oe::ParticleSystemComponent>();
             mIsStart = false;
         }
-        if (oe::World::World::IsExists("Saves/auto_save"))
+        GetSaves();
+        if (mCanContinue)
         {
             if (GuiLayer::Button("Продолжить", ImVec2(100, 30)))
             {
                 mMainMenuMusic.Stop();
                 mMainMenuMusic.~Source();
-                oe::VisualNovel::Init(&mScriptFile);
+                CompactSave autosave{};
+                if (mJournal.Recover(autosave))
+                {
+                    InitVisualNovel();
+                    BeginReplay(ResolveCompactSaveIterator(autosave));
+                }
+                else
+                {
+                    LuaAutoCollectScope gcScope{mLuaHeap};
+                    oe::VisualNovel::Init(&mScriptFile);
+                }
+                mJournal.Open(true);
                 oe::Core::Root::GetWorld()->GetEntity("ParticleSystem").AddComponent<oe::ParticleSystemComponent>();
                 mIsStart = false;
             }
@@ -289,10 +510,13 @@ namespace TSOCA
             GuiLayer::Button("Продолжить", ImVec2(100, 30));
             GuiLayer::PopStyleColor(3);
         }
-        if (std::distance(std::filesystem::directory_iterator("Saves/"), std::filesystem::directory_iterator{}) > 0)
+        if (!GetSaves().empty())
         {
             if (GuiLayer::Button("Сохранения", ImVec2(100, 30)))
+            {
                 mShowSavesMenu = !mShowSavesMenu;
+                mIsSavesDirty = true;
+            }
         }
         else
         {
@@ -317,26 +541,10 @@ namespace TSOCA
             using namespace oe;
             using namespace Renderer;
 
-            std::vector<std::filesystem::path> saves{};
+            auto& saves = mSaves;
             static std::string selectedSave{};
-            const std::string fileName{"player_save"};
-            const auto& path = std::filesystem::directory_iterator("Saves/");
-            int it{};
-
-            for (auto& file : path)
-                saves.push_back(file.path());
-            std::sort(saves.begin(), saves.end());
-            for (auto& save : saves)
-            {
-                std::string saveFile = save.filename().replace_extension().string();
-                if (saveFile.size() >= fileName.size())
-                    saveFile.erase(fileName.size(), saveFile.size());
-                if (saveFile == "player_save")
-                    it++;
-            }
 
-            if (std::filesystem::exists(std::filesystem::path("Saves/player_save" + std::to_string(it) + ".oeworld")))
-                it++;
+            GetSaves();
 
             GuiLayer::Begin("Сохранения");
             if (GuiLayer::Button("Удалить сохранение") && !saves.empty())
@@ -349,17 +557,17 @@ namespace TSOCA
 
             if (GuiLayer::BeginListBox("Список сохранений", ImVec2(-FLT_MIN, GuiLayer::GetWindowHeight())))
             {
-                for (uint32_t i{}; i < saves.size(); ++i)
+                ImGuiListClipper clipper{};
+                clipper.Begin(static_cast<int>(saves.size()));
+                while (clipper.Step())
                 {
-                    auto& save = saves[i];
-                    if (!save.empty())
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
                     {
-                        const bool isSelected = (mSelectedSave == i);
-                        if (ImGui::Selectable(save.string().c_str(), isSelected))
+                        const auto& save = saves[i];
+                        if (!save.empty() && RenderSaveSlot(save, mSelectedSave == static_cast<uint32_t>(i)))
                         {
                             mShowAcceptPopupModal = true;
-                            selectedSave = save.replace_extension().string();
-                            break;
+                            selectedSave = save.string();
                         }
                     }
                 }
@@ -369,7 +577,8 @@ namespace TSOCA
             RenderAcceptPopupModal(selectedSave, GuiLayer::GetMainViewport()->GetCenter());
 
             GuiLayer::CreateSavesPopupModal(saves, "Удалить сохранение", nullptr, [&](auto& selected) {
-                std::filesystem::remove(saves[selected]);
+                RemoveSave(saves[selected]);
+                selected = 0;
             });
 
             GuiLayer::End();
@@ -385,43 +594,26 @@ namespace TSOCA
 
             static std::string selectedSave{};
 
-            std::vector<std::filesystem::path> saves{};
-            const auto& path = std::filesystem::directory_iterator("Saves/");
-            const std::string fileName{"player_save"};
-            int it{};
-
-            for (auto& file : path)
-                saves.push_back(file.path());
-            std::sort(saves.begin(), saves.end());
-
-            for (auto& save : saves)
-            {
-                std::string saveFile = save.filename().replace_extension().string();
-                if (saveFile.size() >= fileName.size())
-                    saveFile.erase(fileName.size(), saveFile.size());
-                if (saveFile == "player_save")
-                    it++;
-            }
+            auto& saves = mSaves;
 
-            if (std::filesystem::exists(std::filesystem::path("Saves/player_save" + std::to_string(it) + ".oeworld")))
-                it++;
-
-            const auto& itStr = std::to_string(it);
+            GetSaves();
 
             GuiLayer::Begin("Сохранения");
             if (GuiLayer::Button("Сохранить"))
             {
-                const auto& currentLabel = VisualNovel::GetCurrentLabel();
-                if (currentLabel == "start")
-                    VisualNovel::Save("Saves/" + fileName + itStr, fileName + itStr);
+                if (mCurrentLabel == Atoms::Start())
+                {
+                    // The write finishes on the IO worker; a second click before the refresh must not reuse the slot.
+                    SaveCompact(mFrameArena.Format("Saves/%s%u.oesave", SAVE_SLOT_NAME, mNextSaveSlot));
+                    mNextSaveSlot++;
+                }
                 else
                     GuiLayer::OpenPopup("Упс...");
             }
 
             if (GuiLayer::Button("Перезаписать сохранение") && !saves.empty())
             {
-                const auto& currentLabel = VisualNovel::GetCurrentLabel();
-                if (currentLabel == "start")
+                if (mCurrentLabel == Atoms::Start())
                     GuiLayer::OpenPopup("Перезаписать сохранение");
                 else
                     GuiLayer::OpenPopup("Упс...");
@@ -437,17 +629,17 @@ namespace TSOCA
 
             if (GuiLayer::BeginListBox("Список сохранений", ImVec2(-FLT_MIN, GuiLayer::GetWindowHeight())))
             {
-                for (uint32_t i{}; i < saves.size(); ++i)
+                ImGuiListClipper clipper{};
+                clipper.Begin(static_cast<int>(saves.size()));
+                while (clipper.Step())
                 {
-                    auto& save = saves[i];
-                    if (!save.empty())
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
                     {
-                        const bool isSelected = (mSelectedSave == i);
-                        if (ImGui::Selectable(save.string().c_str(), isSelected))
+                        const auto& save = saves[i];
+                        if (!save.empty() && RenderSaveSlot(save, mSelectedSave == static_cast<uint32_t>(i)))
                         {
                             mShowAcceptPopupModal = true;
-                            selectedSave = save.replace_extension().string();
-                            break;
+                            selectedSave = save.string();
                         }
                     }
                 }
@@ -469,11 +661,12 @@ namespace TSOCA
             RenderAcceptPopupModal(selectedSave, center);
 
             GuiLayer::CreateSavesPopupModal(saves, "Перезаписать сохранение", nullptr, [&](auto& selected) {
-                const auto& currentLabel = VisualNovel::GetCurrentLabel();
-                if (currentLabel == "start")
+                if (mCurrentLabel == Atoms::Start())
                 {
-                    oe::VisualNovel::Save(saves[selected].replace_extension().string(),
-                                          saves[selected].filename().replace_extension().string());
+                    const auto save = saves[selected];
+                    if (save.extension() != ".oesave")
+                        RemoveSave(save);
+                    SaveCompact(std::filesystem::path(save).replace_extension(".oesave"));
                     selected = 0;
                     selectedSave.clear();
                 }
@@ -482,7 +675,7 @@ namespace TSOCA
             });
 
             GuiLayer::CreateSavesPopupModal(saves, "Удалить сохранение", nullptr, [&](auto& selected) {
-                std::filesystem::remove(saves[selected]);
+                RemoveSave(saves[selected]);
                 selected = 0;
                 selectedSave.clear();
             });
@@ -497,15 +690,32 @@ namespace TSOCA
     {
         using namespace oe;
         using namespace oe::Renderer;
-        static const auto loadSave = [&]() {
+        const auto loadSave = [&]() {
+            const auto savePath = std::filesystem::path(selectedSave);
+            const bool isCompact = savePath.extension() == ".oesave";
             if (mIsStart)
             {
                 mMainMenuMusic.Stop();
                 mMainMenuMusic.~Source();
-                VisualNovel::Init(&mScriptFile, false);
+                mJournal.Open(true);
             }
-            if (!VisualNovel::LoadSave(&mScriptFile, selectedSave))
-                OE_LOG_WARNING("Failed to load world '" + selectedSave + "'!")
+            if (mIsStart || isCompact)
+            {
+                TraceScope initScope{"VisualNovel::Init", "Load"};
+                InitVisualNovel();
+            }
+            if (isCompact)
+            {
+                if (!LoadCompact(savePath))
+                    OE_LOG_WARNING("Failed to load save '" + selectedSave + "'!")
+            }
+            else
+            {
+                TraceScope loadScope{"VisualNovel::LoadSave", "IO", selectedSave};
+                if (!VisualNovel::LoadSave(&mScriptFile, std::filesystem::path(savePath).replace_extension().string()))
+                    OE_LOG_WARNING("Failed to load world '" + selectedSave + "'!")
+            }
+            mRollback.Clear();
             mShowAcceptPopupModal = false;
             mShowSavesMenu = false;
             if (mIsStart)
@@ -519,8 +729,7 @@ namespace TSOCA
         {
             if (mConfigData.renderAcceptPopupModal)
             {
-                GuiLayer::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s",
-                                      ("Вы собираетесь загрузить сохранение \"" + selectedSave + ".oeworld" + "\"").c_str());
+                GuiLayer::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Вы собираетесь загрузить сохранение \"%s\"", selectedSave.c_str());
                 GuiLayer::Separator();
 
                 GuiLayer::AlignText({"Ок", "Отмена"}, 145);
@@ -558,72 +767,41 @@ namespace TSOCA
 
             GuiLayer::Begin("История");
 
+            const bool canRewind = !mIsReplaying && mRollback.GetCount() && mCurrentLabel == Atoms::Start();
+            GuiLayer::BeginDisabled(!canRewind);
+            if (GuiLayer::Button("Назад"))
+                Rewind(1);
+            GuiLayer::EndDisabled();
+            GuiLayer::SameLine();
+            GuiLayer::HelpMarker("Возвращает к предыдущей реплике.");
+            GuiLayer::SameLine();
+            ImGui::SetNextItemWidth(-FLT_MIN);
+            ImGui::InputTextWithHint("##historySearch", "Поиск", mHistoryQuery, sizeof(mHistoryQuery));
+
             if (GuiLayer::BeginListBox("Список истории", ImVec2(-FLT_MIN, GuiLayer::GetWindowHeight() / 1.25f)))
             {
                 const auto currentIt = oe::VisualNovel::GetCurrentIterator();
                 static auto prevIt = currentIt;
                 const auto& instructions = oe::VisualNovel::GetInstructions();
-                for (uint32_t i{}; i < currentIt; ++i)
-                {
-                    const auto& instruction = instructions[i];
+                const auto pushLine = [&](uint32_t i) {
                     if (instructions[i].EqualType(oe::VisualNovel::SAY_TEXT))
                     {
-                        const std::string text =
-                            instruction.characterData.character->GetName().empty()
-                                ? instruction.characterData.text
-                                : instruction.characterData.character->GetName() + ": " + instruction.characterData.text;
-                        std::string text2u8{};
-                        bool checkForParseCmd{};
-                        bool parseCmd{};
-
-                        const auto parseCommand = [&](char ch) {
-                            if (checkForParseCmd)
-                            {
-                                if (ch == '/')
-                                {
-                                    checkForParseCmd = false;
-                                    parseCmd = true;
-                                    return false;
-                                }
-                                else
-                                {
-                                    text2u8 += '[';
-                                    checkForParseCmd = false;
-                                }
-                            }
-
-                            if (parseCmd)
-                            {
-                                if (ch == ']')
-                                {
-                                    parseCmd = false;
-                                    return false;
-                                }
-                                return false;
-                            }
-
-                            if (ch == '[')
-                            {
-                                checkForParseCmd = true;
-                                return false;
-                            }
-
-                            return true;
-                        };
-
-                        for (auto& character : text)
-                        {
-                            if (!parseCommand(character))
-                                continue;
-                            text2u8 += character;
-                        }
-
-                        std::u8string u8String{text2u8.begin(), text2u8.end()};
-                        GuiLayer::TextWrapped("%s", u8String.c_str());
+                        const auto text = GetSayText(instructions[i], &mFrameArena);
+                        GuiLayer::TextWrapped("%s", text.c_str());
                         GuiLayer::Separator();
                     }
+                };
+                if (mHistoryQuery[0])
+                {
+                    for (const auto i : mSearchIndex.Search(mHistoryQuery, currentIt))
+                        pushLine(i);
                 }
-                if (mConfigData.autoScrollHistory && prevIt != currentIt)
+                else
+                {
+                    for (uint32_t i{}; i < currentIt && i < instructions.size(); ++i)
+                        pushLine(i);
+                }
+                if (mConfigData.autoScrollHistory && prevIt != currentIt && !mHistoryQuery[0])
                 {
                     GuiLayer::SetScrollY(GuiLayer::GetWindowHeight() * GuiLayer::GetWindowHeight());
                     prevIt = currentIt;
@@ -671,9 +849,57 @@ namespace TSOCA
             GuiLayer::Text("Current iterator: %i", currentIt);
 
             GuiLayer::Text("Is render choice menu: %i", VisualNovel::IsRenderChoiceMenu());
+            GuiLayer::Text("Rollback lines: %zu / %zu", mRollback.GetCount(), mRollback.GetCapacity());
+            GuiLayer::Text("Autosave journal: %u records, generation %u, last append %.3fus", mJournal.GetCount(),
+                           mJournal.GetGeneration(), mLastJournalAppendTime);
+            GuiLayer::Text("IO worker: %u pending jobs", mIoWorker.GetPendingCount());
+            const auto& luaAllocator = mLuaHeap.GetAllocator();
+            GuiLayer::Text("Lua heap: %.1f KB, GC %.3f ms/frame, %u cycles, %u catch-up frames", mLuaHeap.GetHeapBytes() / 1024.0,
+                           mLuaHeap.GetLastStepTime(), mLuaHeap.GetCyclesCount(), mLuaHeap.GetCatchUpFramesCount());
+            GuiLayer::Text("Lua pools: %.1f KB in %u slabs, %llu pooled / %llu large allocations", luaAllocator.GetPoolBytes() / 1024.0,
+                           luaAllocator.GetSlabsCount(), static_cast<unsigned long long>(luaAllocator.GetPooledAllocations()),
+                           static_cast<unsigned long long>(luaAllocator.GetLargeAllocations()));
+            GuiLayer::Text("Frame arena: %u allocs, %.1f / %.1f KB, %u heap spills", mFrameArena.GetFrameAllocations(),
+                           mFrameArena.GetFrameBytes() / 1024.0f, mFrameArena.GetCapacity() / 1024.0f,
+                           mFrameArena.GetFrameHeapAllocations());
+            // The arena only sees what is routed through it; the tracker counts every operator new.
+            if constexpr (AllocationTracker::IS_ENABLED)
+            {
+                uint64_t frameAllocations{};
+                for (uint8_t scope{}; scope < ALLOCATION_SCOPES_COUNT; ++scope)
+                    frameAllocations += AllocationTracker::GetCounters(static_cast<AllocationScope>(scope)).frameAllocations;
+                GuiLayer::Text("Heap allocations last frame: %llu", static_cast<unsigned long long>(frameAllocations));
+            }
+            else
+                GuiLayer::Text("Heap allocations last frame: build with TSOCA_TRACK_ALLOCATIONS to count");
+            GuiLayer::Text("Atoms: %zu (%.1f KB)", Atom::GetCount(), Atom::GetMemoryUsage() / 1024.0f);
 
             if (GuiLayer::Button("Show Demo Window"))
                 mShowDemoWindow = !mShowDemoWindow;
+            GuiLayer::SameLine();
+            if (!TraceRecorder::IsRecording())
+            {
+                if (GuiLayer::Button("Start Trace"))
+                    TraceRecorder::Start("trace.json");
+            }
+            else
+            {
+                if (GuiLayer::Button("Stop Trace") && !TraceRecorder::Stop())
+                    OE_LOG_WARNING("Failed to write trace!");
+                GuiLayer::SameLine();
+                GuiLayer::Text("%zu events", TraceRecorder::GetEventsCount());
+            }
+
+            GuiLayer::Checkbox("Hot Reload Scripts", &mIsHotReloadEnabled);
+            GuiLayer::SameLine();
+            if (GuiLayer::Button("Reload Now") && !mIsReplaying)
+            {
+                mScriptWatcher.Reset();
+                ReloadScripts({"Assets/Scripts/main.lua"});
+            }
+            if (mLastHotReload.time > 0.0f)
+                GuiLayer::Text("Last reload: %.1fms, iterator %u -> %u", mLastHotReload.time, mLastHotReload.prevIterator,
+                               mLastHotReload.iterator);
 
             GuiLayer::DragFloat("Auto Skip Time", &mConfigData.autoSkipTime, 0.01f, 0.0f, 5.0f);
 
@@ -681,80 +907,66 @@ namespace TSOCA
             {
                 if (GuiLayer::BeginListBox("Instructions List", ImVec2(-FLT_MIN, GuiLayer::GetWindowHeight() / 2)))
                 {
-                    for (uint32_t i{}; i < instructions.size(); ++i)
+                    // Titles are only formatted for the rows on screen.
+                    ImGuiListClipper clipper{};
+                    clipper.Begin(static_cast<int>(instructions.size()));
+                    while (clipper.Step())
                     {
-                        const bool isSelected = (currentIt == i + 1);
-                        std::string title = std::to_string(i) + ": ";
-                        const auto& instruction = instructions[i];
-                        switch (instruction.type)
+                        for (auto i = static_cast<uint32_t>(clipper.DisplayStart); i < static_cast<uint32_t>(clipper.DisplayEnd); ++i)
                         {
-                        case VisualNovel::CHANGE_SCENE:
-                            title += "Change Scene | " + instruction.sceneEntity.GetComponent<TagComponent>().Tag;
-                            break;
-                        case VisualNovel::SHOW_CHARACTER:
-                            title += "Show Character | " + instruction.characterData.character->GetName() + ":" +
-                                     instruction.characterData.emotion;
-                            break;
-                        case VisualNovel::HIDE_CHARACTER:
-                            title += "Hide Character | " + instruction.characterData.character->GetName() + ":" +
-                                     instruction.characterData.emotion;
-                            break;
-                        case VisualNovel::PLAY_MUSIC:
-                            title += "Play Music | Is playing: " + std::to_string(instruction.audioSource->IsPlaying());
-                            break;
-                        case VisualNovel::STOP_MUSIC:
-                            title += "Stop Music | Is playing: " + std::to_string(instruction.audioSource->IsPlaying());
-                            break;
-                        case VisualNovel::PLAY_SOUND:
-                            title += "Play Sound | Is playing: " + std::to_string(instruction.audioSource->IsPlaying());
-                            break;
-                        case VisualNovel::STOP_SOUND:
-                            title += "Stop Sound | Is playing: " + std::to_string(instruction.audioSource->IsPlaying());
-                            break;
-                        case VisualNovel::PLAY_AMBIENT:
-                            title += "Play Ambient | Is playing: " + std::to_string(instruction.audioSource->IsPlaying());
-                            break;
-                        case VisualNovel::STOP_AMBIENT:
-                            title += "Stop Ambient | Is playing: " + std::to_string(instruction.audioSource->IsPlaying());
-                            break;
-                        case VisualNovel::JUMP_TO_LABEL: title += "Jump To Label | " + instruction.label.name; break;
-                        case VisualNovel::MOVE_CHARACTER: {
-                            const auto& pos = instruction.characterData.character->GetCurrentPosition();
-                            title += "Move Sprite | " + instruction.characterData.character->GetName() + ":" +
-                                     instruction.characterData.emotion + " to (" + std::to_string(pos.x) + ", " + std::to_string(pos.y) +
-                                     ", " + std::to_string(pos.z) + ")";
-                            break;
-                        }
-                        case VisualNovel::SAY_TEXT:
-                            title += "Say Text | " + instruction.characterData.character->GetName() + ": " + instruction.characterData.text;
-                            break;
-                        case VisualNovel::CHOICE_MENU: {
-                            title += "Choice Menu | ";
-                            int iter{};
-                            for (const auto& item : instruction.choiceMenuItems)
+                            const bool isSelected = (currentIt == i + 1);
+                            auto title = mFrameArena.MakeString(mFrameArena.Format("%u: ", i));
+                            const auto& instruction = instructions[i];
+                            title += GetInstructionTitle(instruction, &mFrameArena);
+                            if (IsAudioInstruction(instruction))
+                                title += mFrameArena.Format(" | Is playing: %d", instruction.audioSource->IsPlaying());
+                            else if (instruction.EqualType(VisualNovel::MOVE_CHARACTER))
                             {
-                                if ((iter % 2) == 0)
-                                    title += "var = " + item + "; ";
-                                else
-                                    title += "target = " + item + "; ";
-                                iter++;
+                                const auto& pos = instruction.characterData.character->GetCurrentPosition();
+                                title += mFrameArena.Format(" to (%f, %f, %f)", pos.x, pos.y, pos.z);
                             }
-                            break;
-                        }
-                        case VisualNovel::SET_TEXT_SPEED: break;
-                        case VisualNovel::SHOW_TEXTBOX: title += "Show Text Box | " + std::to_string(instruction.animationSpeed); break;
-                        case VisualNovel::HIDE_TEXTBOX: title += "Hide Text Box | " + std::to_string(instruction.animationSpeed); break;
-                        case VisualNovel::WAIT:
-                            title += "Wait | " + std::to_string(instruction.animationSpeed) + " / " + std::string(instruction.target);
-                            break;
-                        case VisualNovel::CHANGE_TEXTBOX:
-                            title += "Change Text Box | " + instruction.textBox->GetSprite()->GetTexture()->GetData()->Path;
-                            break;
-                        case VisualNovel::LOAD_FRAMEBUFFER_SHADER: title += "Load FrameBuffer Shader | " + instruction.target; break;
+
+                            ImGui::Selectable(title.c_str(), isSelected);
+
+                            if (isSelected)
+                                ImGui::SetItemDefaultFocus();
                         }
+                    }
+                    ImGui::EndListBox();
+                }
+            }
 
-                        ImGui::Selectable(title.c_str(), isSelected);
+            if constexpr (AllocationTracker::IS_ENABLED)
+            {
+                if (GuiLayer::CollapsingHeader("Allocations"))
+                {
+                    for (uint8_t scope{}; scope < ALLOCATION_SCOPES_COUNT; ++scope)
+                    {
+                        const auto counters = AllocationTracker::GetCounters(static_cast<AllocationScope>(scope));
+                        GuiLayer::Text("%s: %.1f KB live, %.1f KB peak, %llu / frame, %llu total",
+                                       AllocationTracker::GetScopeName(static_cast<AllocationScope>(scope)), counters.liveBytes / 1024.0,
+                                       counters.peakBytes / 1024.0, static_cast<unsigned long long>(counters.frameAllocations),
+                                       static_cast<unsigned long long>(counters.allocations));
+                    }
+                }
+            }
 
+            if (GuiLayer::CollapsingHeader("Script Analysis"))
+            {
+                if (mScriptAnalysis.instructionResources.size() != instructions.size())
+                    mScriptAnalysis = AnalyzeScript();
+                const auto* currentRange = mScriptAnalysis.FindRange(currentIt ? currentIt - 1 : 0);
+                GuiLayer::Text("Resources: %zu", mScriptAnalysis.resources.size());
+                GuiLayer::Text("Peak resident: %.2f MB at %u", mScriptAnalysis.peakBytes / (1024.0 * 1024.0), mScriptAnalysis.peakIterator);
+                if (GuiLayer::BeginListBox("Ranges List", ImVec2(-FLT_MIN, GuiLayer::GetWindowHeight() / 4)))
+                {
+                    for (const auto& range : mScriptAnalysis.ranges)
+                    {
+                        const bool isSelected = (&range == currentRange);
+                        const char* title = mFrameArena.Format("%s [%u, %u) | %zu resources, %llu KB", range.label.c_str(), range.begin,
+                                                               range.end, range.resources.size(),
+                                                               static_cast<unsigned long long>(range.peakBytes / 1024));
+                        ImGui::Selectable(title, isSelected);
                         if (isSelected)
                             ImGui::SetItemDefaultFocus();
                     }
@@ -762,6 +974,34 @@ namespace TSOCA
                 }
             }
 
+            if (GuiLayer::CollapsingHeader("Script Search"))
+            {
+                ImGui::InputTextWithHint("##scriptSearch", "Words", mScriptQuery, sizeof(mScriptQuery));
+                const auto searchBegin = std::chrono::steady_clock::now();
+                const auto results = mSearchIndex.Search(mScriptQuery);
+                const std::chrono::duration<float, std::micro> searchTime{std::chrono::steady_clock::now() - searchBegin};
+                GuiLayer::Text("Index: %zu words%s | %zu results in %.1fus", mSearchIndex.GetWordsCount(),
+                               mSearchIndex.IsComplete() ? "" : " (building)", results.size(), searchTime.count());
+                if (GuiLayer::BeginListBox("Search Results", ImVec2(-FLT_MIN, GuiLayer::GetWindowHeight() / 4)))
+                {
+                    ImGuiListClipper clipper{};
+                    clipper.Begin(static_cast<int>(results.size()));
+                    while (clipper.Step())
+                    {
+                        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+                        {
+                            // Jumping replays from the start, which stops at choice menus.
+                            const auto i = results[row];
+                            const auto title = GetInstructionTitle(instructions[i], &mFrameArena);
+                            if (ImGui::Selectable(mFrameArena.Format("%u | %s", i, title.c_str()), i + 1 == currentIt) &&
+                                !mIsReplaying)
+                                JumpToInstruction(i + 1);
+                        }
+                    }
+                    ImGui::EndListBox();
+                }
+            }
+
             if (GuiLayer::CollapsingHeader("Backgrounds"))
             {
                 PushBackgroundInfo("Previous background", prevBackground);
@@ -774,7 +1014,7 @@ namespace TSOCA
                 for (uint32_t i{}; i < currentCharactersCount; ++i)
                 {
                     const auto& character = currentCharacters[i];
-                    if (GuiLayer::TreeNode(("Character" + std::to_string(i)).c_str()))
+                    if (GuiLayer::TreeNode(mFrameArena.Format("Character%u", i)))
                     {
                         if (GuiLayer::TreeNode("Sprite2DComponent"))
                         {
@@ -918,7 +1158,10 @@ namespace TSOCA
             if (GuiLayer::Button("Продолжить", ImVec2(100, 30)))
                 mShowEscapeMenu = false;
             if (GuiLayer::Button("Сохранения", ImVec2(100, 30)))
+            {
                 mShowSavesMenu = true;
+                mIsSavesDirty = true;
+            }
             if (GuiLayer::Button("Настройки", ImVec2(100, 30)))
                 mShowSettingsMenu = true;
             if (GuiLayer::Button("История", ImVec2(100, 30)))
@@ -938,19 +1181,14 @@ namespace TSOCA
 
     void Application::ProcessVnWaiting(float deltaTime)
     {
-        if (!mShowEscapeMenu && oe::VisualNovel::IsWaiting() && oe::VisualNovel::GetWaitTarget() == "end")
+        using namespace oe;
+        auto& particleSystem = Core::Root::GetWorld()->GetEntity("ParticleSystem").GetComponent<ParticleSystemComponent>();
+        // Particles are randomised by the engine, so benchmark runs leave them out of the hashed frames.
+        if (!mBenchmark && !mShowEscapeMenu && VisualNovel::IsWaiting() && std::string_view{VisualNovel::GetWaitTarget()} == "end")
         {
-            using namespace oe;
-            using namespace Renderer;
-            auto pProps =
-                Core::Root::GetWorld()->GetEntity("ParticleSystem").GetComponent<oe::ParticleSystemComponent>().GetParticleProps("main");
+            auto pProps = particleSystem.GetParticleProps("main");
             if (!pProps)
-            {
-                pProps = Core::Root::GetWorld()
-                             ->GetEntity("ParticleSystem")
-                             .GetComponent<ParticleSystemComponent>()
-                             .CreateParticleProps("main", 10);
-            }
+                pProps = particleSystem.CreateParticleProps("main", 10);
             pProps->SizeBegin = 0.0075f;
             pProps->SizeEnd = 0.0025f;
             pProps->SizeVariation = 0.015f;
@@ -960,18 +1198,15 @@ namespace TSOCA
             pProps->LifeTime = 1.5f;
             pProps->RotationAngleBegin = 0.0f;
             pProps->RotationAngleEnd = 360.0f;
-            pProps->Position = mParticlePositions[mCurrentParticlePos];
             if (mCurrentParticlePos == mParticlePositions.size())
                 mCurrentParticlePos = 0;
+            pProps->Position = mParticlePositions[mCurrentParticlePos];
             if (mCurrentParticlePos == 0)
                 pProps->LifeTime = 0.0f;
             mCurrentParticlePos++;
         }
         else
-            oe::Core::Root::GetWorld()
-                ->GetEntity("ParticleSystem")
-                .GetComponent<oe::ParticleSystemComponent>()
-                .DestroyParticleProps("main");
+            particleSystem.DestroyParticleProps("main");
     }
 
     void Application::PushBackgroundInfo(const std::string& title, const oe::World::Entity& background)
@@ -1028,6 +1263,288 @@ namespace TSOCA
         }
     }
 
+    void Application::NextStep()
+    {
+        using namespace oe;
+        if (mIsReplaying)
+            return;
+        AllocationScopeGuard vnScope{VN_SCOPE};
+        const auto prevIt = VisualNovel::GetCurrentIterator();
+        const auto stepBegin = std::chrono::steady_clock::now();
+        VisualNovel::NextStep();
+        const auto stepEnd = std::chrono::steady_clock::now();
+        UpdateCurrentLabel();
+        if (TraceRecorder::IsRecording())
+            TraceNextStep(prevIt, stepBegin, stepEnd);
+        if (VisualNovel::GetCurrentIterator() != prevIt)
+        {
+            mRollback.Push(prevIt);
+            AppendJournal();
+        }
+    }
+
+    void Application::TraceNextStep(uint32_t prevIt, std::chrono::steady_clock::time_point begin,
+                                    std::chrono::steady_clock::time_point end)
+    {
+        TraceRecorder::AddEvent("VisualNovel::NextStep", "VN", begin, end);
+        // Shader compiles and audio starts happen inside the engine's step, so they get the step's timing.
+        using namespace oe;
+        const auto& instructions = VisualNovel::GetInstructions();
+        const auto currentIt = std::min<size_t>(VisualNovel::GetCurrentIterator(), instructions.size());
+        for (auto i = prevIt; i < currentIt; ++i)
+        {
+            const auto& instruction = instructions[i];
+            if (instruction.EqualType(VisualNovel::LOAD_FRAMEBUFFER_SHADER))
+                TraceRecorder::AddEvent("LoadFramebufferShader", "Load", begin, end, instruction.target);
+            else if (instruction.EqualType(VisualNovel::PLAY_MUSIC) || instruction.EqualType(VisualNovel::PLAY_SOUND) ||
+                     instruction.EqualType(VisualNovel::PLAY_AMBIENT))
+                TraceRecorder::AddEvent("PlayAudio", "Audio", begin, end, GetInstructionTitle(instruction));
+        }
+    }
+
+    void Application::AppendJournal()
+    {
+        if (mCurrentLabel != Atoms::Start())
+            return;
+        TraceScope journalScope{"Journal::Append", "IO"};
+        const auto begin = std::chrono::steady_clock::now();
+        mJournal.Append(CaptureCompactSave());
+        if (mJournal.IsCompactDue())
+        {
+            // The checkpoint write runs on the IO worker; the journal keeps appending meanwhile.
+            auto isWritten = std::make_shared<bool>();
+            mIoWorker.Submit(
+                [isWritten, path = mJournal.GetCheckpointPath(), save = mJournal.BeginCompact()] {
+                    TraceScope compactScope{"Journal::Compact", "IO"};
+                    *isWritten = WriteCompactSave(path, save);
+                },
+                [this, isWritten] { mJournal.EndCompact(*isWritten); });
+        }
+        mLastJournalAppendTime = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    void Application::Rewind(uint32_t steps)
+    {
+        uint32_t iterator{};
+        if (mIsReplaying || !mRollback.Rewind(steps, iterator))
+            return;
+        InitVisualNovel();
+        BeginReplay(iterator);
+    }
+
+    void Application::JumpToInstruction(uint32_t iterator)
+    {
+        InitVisualNovel();
+        mRollback.Clear();
+        BeginReplay(iterator);
+    }
+
+    void Application::UpdateCurrentLabel()
+    {
+        // The label only changes by stepping, so the string is interned once per new position, not every frame.
+        const auto currentIt = oe::VisualNovel::GetCurrentIterator();
+        if (currentIt == mCurrentLabelIterator)
+            return;
+        mCurrentLabelIterator = currentIt;
+        mCurrentLabel = Atom{oe::VisualNovel::GetCurrentLabel()};
+    }
+
+    void Application::BeginReplay(uint32_t iterator)
+    {
+        // The script was restarted, so the cached label may belong to the old run.
+        mCurrentLabelIterator = UINT32_MAX;
+        mReplayTarget = iterator;
+        mReplayStalledSteps = 0;
+        mIsReplaying = oe::VisualNovel::GetCurrentIterator() < iterator;
+        if (!mIsReplaying)
+            return;
+        // Text appears instantly at speed 100; audio started on the way would only click.
+        oe::VisualNovel::SetTextSpeed(100.0f);
+        Hazel::Audio::SetGlobalVolume(0.0f);
+    }
+
+    void Application::UpdateReplay()
+    {
+        using namespace oe;
+        constexpr uint32_t maxStepsPerFrame{64};
+        constexpr uint32_t maxStalledSteps{8};
+        constexpr float stepDeltaTime{60.0f};
+
+        for (uint32_t step{}; step < maxStepsPerFrame && VisualNovel::GetCurrentIterator() < mReplayTarget; ++step)
+        {
+            const auto prevIt = VisualNovel::GetCurrentIterator();
+            VisualNovel::NextStep();
+            VisualNovel::Update(stepDeltaTime, true);
+            if (VisualNovel::GetCurrentIterator() != prevIt)
+                mReplayStalledSteps = 0;
+            else if (++mReplayStalledSteps >= maxStalledSteps || VisualNovel::IsRenderChoiceMenu())
+            {
+                OE_LOG_WARNING("Replay stopped at " + std::to_string(prevIt) + " instead of " + std::to_string(mReplayTarget) + "!");
+                break;
+            }
+        }
+
+        if (VisualNovel::GetCurrentIterator() >= mReplayTarget || mReplayStalledSteps >= maxStalledSteps ||
+            VisualNovel::IsRenderChoiceMenu())
+        {
+            mIsReplaying = false;
+            VisualNovel::SetTextSpeed(mConfigData.textSpeed);
+            Hazel::Audio::SetGlobalVolume(mConfigData.audioVolume);
+            AppendJournal();
+        }
+    }
+
+    void Application::SaveCompact(const std::filesystem::path& path)
+    {
+        struct PendingSave
+        {
+            std::filesystem::path path{};
+            CompactSave save{};
+            SaveHeader header{};
+            bool isSaveWritten{};
+            bool isHeaderWritten{};
+        };
+
+        // Engine state is captured here; only the file writes run on the IO worker.
+        TraceScope saveScope{"SaveCompact", "IO", path.string()};
+        UpdatePendingSaveHeader();
+        auto pending = std::make_shared<PendingSave>(PendingSave{path, CaptureCompactSave(), mPendingSaveHeader});
+        mIoWorker.Submit(
+            [pending] {
+                TraceScope writeScope{"WriteCompactSave", "IO", pending->path.string()};
+                pending->isSaveWritten = WriteCompactSave(pending->path, pending->save);
+                if (pending->isSaveWritten)
+                    pending->isHeaderWritten = WriteSaveHeader(pending->path, pending->header);
+            },
+            [this, pending] {
+                if (!pending->isSaveWritten)
+                    OE_LOG_WARNING("Failed to write save '" + pending->path.string() + "'!");
+                else if (!pending->isHeaderWritten)
+                    OE_LOG_WARNING("Failed to write save header for '" + pending->path.string() + "'!");
+                mSaveHeaders.Invalidate(pending->path);
+                mIsSavesDirty = true;
+            });
+    }
+
+    bool Application::LoadCompact(const std::filesystem::path& path)
+    {
+        TraceScope loadScope{"LoadCompact", "IO", path.string()};
+        mIoWorker.Wait();
+        mRollback.Clear();
+        CompactSave save{};
+        if (!ReadCompactSave(path, save))
+            return false;
+        BeginReplay(ResolveCompactSaveIterator(save));
+        return true;
+    }
+
+    const std::vector<std::filesystem::path>& Application::GetSaves()
+    {
+        if (!mIsSavesDirty)
+            return mSaves;
+
+        mSaves.clear();
+        for (const auto& file : std::filesystem::directory_iterator("Saves/"))
+        {
+            // The journal checkpoint is shown as "Continue", not as a slot.
+            const auto& extension = file.path().extension();
+            if ((extension == ".oeworld" || extension == ".oesave") &&
+                file.path().filename() != mJournal.GetCheckpointPath().filename())
+                mSaves.push_back(file.path());
+        }
+        std::sort(mSaves.begin(), mSaves.end());
+        mSaveHeaders.Refresh(mSaves);
+
+        // One past the numbered slots, skipping numbers still taken after a slot in between was deleted.
+        const auto isSlotTaken = [this](uint32_t slot) {
+            const auto stem = SAVE_SLOT_NAME + std::to_string(slot);
+            return std::any_of(mSaves.begin(), mSaves.end(), [&](const auto& save) { return save.stem() == stem; });
+        };
+        mNextSaveSlot = static_cast<uint32_t>(std::count_if(mSaves.begin(), mSaves.end(), [](const auto& save) {
+            return save.stem().string().starts_with(SAVE_SLOT_NAME);
+        }));
+        while (isSlotTaken(mNextSaveSlot))
+            mNextSaveSlot++;
+
+        mCanContinue = mJournal.IsExists() || oe::World::World::IsExists("Saves/auto_save");
+        mIsSavesDirty = false;
+        return mSaves;
+    }
+
+    bool Application::RenderSaveSlot(const std::filesystem::path& save, bool isSelected)
+    {
+        using namespace oe::Renderer;
+        const ImVec2 thumbnailSize{128.0f, 72.0f};
+        const auto* header = mSaveHeaders.Get(save);
+        const auto cursorPos = GuiLayer::GetCursorPos();
+
+        const bool isClicked = GuiLayer::Selectable(mFrameArena.Format("##%s", mFrameArena.ToString(save).c_str()), isSelected,
+                                                    ImGuiSelectableFlags_AllowItemOverlap, ImVec2(0, thumbnailSize.y));
+        GuiLayer::SetCursorPos(cursorPos);
+
+        if (const auto texture = mSaveHeaders.GetThumbnail(save))
+            GuiLayer::Image(reinterpret_cast<ImTextureID>(static_cast<intptr_t>(texture)), thumbnailSize);
+        else
+            GuiLayer::Dummy(thumbnailSize);
+        GuiLayer::SameLine();
+
+        GuiLayer::BeginGroup();
+        GuiLayer::TextUnformatted(mFrameArena.ToString(save.stem()).c_str());
+        if (header)
+        {
+            char time[32]{};
+            const std::time_t timestamp = header->timestamp;
+            std::strftime(time, sizeof(time), "%d.%m.%Y %H:%M", std::localtime(&timestamp));
+            GuiLayer::TextDisabled("%s | %s:%u", time, header->label, header->iterator);
+            GuiLayer::TextWrapped("%s", header->lastLine);
+        }
+        GuiLayer::EndGroup();
+
+        return isClicked;
+    }
+
+    void Application::CaptureSceneThumbnail()
+    {
+        mPendingSaveHeader.hasThumbnail = 0;
+        RequestFrameCapture([this](const std::vector<uint8_t>& pixels, int width, int height) {
+            FillThumbnail(mPendingSaveHeader, pixels, width, height);
+        });
+    }
+
+    void Application::UpdatePendingSaveHeader()
+    {
+        using namespace oe;
+        auto& header = mPendingSaveHeader;
+        header.timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        header.iterator = VisualNovel::GetCurrentIterator();
+        CopyUtf8Truncated(VisualNovel::GetCurrentLabel(), header.label, sizeof(header.label));
+        CopyUtf8Truncated(GetLastSayText(), header.lastLine, sizeof(header.lastLine));
+    }
+
+    void Application::RemoveSave(const std::filesystem::path& save)
+    {
+        mIoWorker.Wait();
+        std::filesystem::remove(save);
+        std::filesystem::remove(GetSaveHeaderPath(save));
+        mSaveHeaders.Invalidate(save);
+        mIsSavesDirty = true;
+    }
+
+    std::string Application::GetLastSayText() const
+    {
+        const auto& instructions = oe::VisualNovel::GetInstructions();
+        const auto currentIt = std::min<size_t>(oe::VisualNovel::GetCurrentIterator(), instructions.size());
+        for (auto i = static_cast<int64_t>(currentIt) - 1; i >= 0; --i)
+        {
+            if (instructions[i].EqualType(oe::VisualNovel::SAY_TEXT))
+            {
+                const auto text = GetSayText(instructions[i]);
+                return {text.begin(), text.end()};
+            }
+        }
+        return {};
+    }
+
     void Application::LoadGuiFont()
     {
         auto& io = ImGui::GetIO();
@@ -1057,12 +1574,53 @@ namespace TSOCA
     {
         mScriptFile.OpenLibraries(sol::lib::base);
         mScriptFile.Init();
+        if (auto* state = GetLuaState(mScriptFile))
+            mLuaHeap.Install(state);
+        else
+            OE_LOG_WARNING("Lua state is not reachable, keeping the default allocator and collector!");
+        LuaAutoCollectScope gcScope{mLuaHeap};
         mScriptFile.RequireFile("", "Assets/Scripts/resources.lua");
         mScriptFile.LoadFile("Assets/Scripts/config.lua", false);
         mScriptFile.LoadFile("Assets/Scripts/utils.lua", false);
         mScriptFile.LoadFile("Assets/Scripts/main.lua", false);
     }
 
+    void Application::InitVisualNovel()
+    {
+        LuaAutoCollectScope gcScope{mLuaHeap};
+        oe::VisualNovel::Init(&mScriptFile, false);
+    }
+
+    void Application::ReloadScripts(const std::vector<std::filesystem::path>& changed)
+    {
+        using namespace oe;
+        TraceScope reloadScope{"ReloadScripts", "Load"};
+        const auto begin = std::chrono::steady_clock::now();
+
+        // resources.lua loads every asset; when it is untouched the loaded assets stay in the Lua state.
+        const bool isResourcesChanged = std::any_of(changed.begin(), changed.end(),
+                                                    [](const auto& file) { return file.filename() == "resources.lua"; });
+        if (isResourcesChanged)
+            InitScripts();
+        else
+        {
+            LuaAutoCollectScope gcScope{mLuaHeap};
+            mScriptFile.LoadFile("Assets/Scripts/config.lua", false);
+            mScriptFile.LoadFile("Assets/Scripts/utils.lua", false);
+            mScriptFile.LoadFile("Assets/Scripts/main.lua", false);
+        }
+
+        const auto prevFingerprints = CollectScriptFingerprints();
+        const auto prevIt = VisualNovel::GetCurrentIterator();
+        InitVisualNovel();
+        const auto target = MapScriptIterator(prevFingerprints, CollectScriptFingerprints(), prevIt);
+        mSearchIndex.Clear();
+
+        mRollback.Clear();
+        BeginReplay(target);
+        mLastHotReload = {prevIt, target, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - begin).count()};
+    }
+
     void Application::SetFullScreenFromConfig()
     {
         const auto* videoMode = glfwGetVideoMode(mConfigData.windowMonitor);
@@ -1306,9 +1864,11 @@ namespace TSOCA
 #pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
 namespace oe::Runtime
 {
-    std::shared_ptr<Application> CreateApplication(int, char*[])
+    std::shared_ptr<Application> CreateApplication(int argc, char* argv[])
     {
-        return std::make_shared<TSOCA::Application>("The Suffering of Carl Allen", 1600, 900);
+        auto application = std::make_shared<TSOCA::Application>("The Suffering of Carl Allen", 1600, 900);
+        application->SetLaunchOptions(TSOCA::LaunchOptions::Parse(argc, argv));
+        return application;
     }
 } // namespace oe::Runtime
 #pragma clang diagnostic pop
\ No newline at end of file
@@ -5,13 +5,28 @@
 
 #pragma once
 
+#include "AllocationTracker.hpp"
+#include "Atom.hpp"
+#include "AutosaveJournal.hpp"
+#include "Benchmark.hpp"
+#include "FrameArena.hpp"
 #include "HazelAudio/HazelAudio.h"
+#include "LaunchOptions.hpp"
+#include "LuaHeap.hpp"
+#include "RollbackBuffer.hpp"
+#include "SaveHeader.hpp"
+#include "ScriptAnalyzer.hpp"
+#include "ScriptWatcher.hpp"
+#include "TextSearchIndex.hpp"
+#include "TraceRecorder.hpp"
+#include "WorkerThread.hpp"
 #include "Oneiro/Lua/LuaFile.hpp"
 #include "Oneiro/Renderer/OpenGL/Texture.hpp"
 #include "Oneiro/Runtime/Application.hpp"
 #include "Oneiro/World/World.hpp"
 #include "imconfig.h"
 #include "imgui.h"
+#include <cstdlib>
 #include <filesystem>
 
 namespace oe::Renderer::GuiLayer
@@ -42,10 +57,16 @@ namespace TSOCA
 
         void OnShutdown() override;
 
+        void SetLaunchOptions(const LaunchOptions& options);
+
       private:
         void LoadGuiFont();
         void SetupGuiStyle();
         void InitScripts();
+        // Re-runs the changed scripts and replays to the equivalent position in the new instructions.
+        void ReloadScripts(const std::vector<std::filesystem::path>& changed);
+        // Rebuilds the engine's instructions with Lua collecting on its own.
+        void InitVisualNovel();
         void SetMonitorFromConfig();
         void SetFullScreenFromConfig();
         void LoadWindowIcon();
@@ -59,10 +80,32 @@ namespace TSOCA
 
         void ProcessVnWaiting(float deltaTime);
 
+        void NextStep();
+        void TraceNextStep(uint32_t prevIt, std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end);
+        void AppendJournal();
+        void UpdateCurrentLabel();
+        // Restarts the script and replays to the line `steps` back, over several frames on long scripts.
+        void Rewind(uint32_t steps);
+        void BeginReplay(uint32_t iterator);
+        void UpdateReplay();
+
+        // Debug only: restarts the script and replays up to `iterator`.
+        void JumpToInstruction(uint32_t iterator);
+
+        void SaveCompact(const std::filesystem::path& path);
+        bool LoadCompact(const std::filesystem::path& path);
+
         void RenderAcceptPopupModal(const std::string& selectedSave, const ImVec2& center);
 
         void PushBackgroundInfo(const std::string& title, const oe::World::Entity& background);
 
+        const std::vector<std::filesystem::path>& GetSaves();
+        bool RenderSaveSlot(const std::filesystem::path& save, bool isSelected);
+        void CaptureSceneThumbnail();
+        void UpdatePendingSaveHeader();
+        void RemoveSave(const std::filesystem::path& save);
+        [[nodiscard]] std::string GetLastSayText() const;
+
         void SaveSpecifications();
 
         struct ConfigData
@@ -122,13 +165,48 @@ namespace TSOCA
         // clang-format on
 
         ConfigData mConfigData{};
+        LaunchOptions mLaunchOptions{};
+        std::unique_ptr<Benchmark> mBenchmark{};
+        // Process exit status for tool runs; the engine's main always returns 0.
+        int mExitCode{EXIT_SUCCESS};
 
+        // Declared before the script file, whose state frees its blocks through it.
+        LuaHeap mLuaHeap{};
         oe::Lua::File mScriptFile{};
         Hazel::Audio::Source mMainMenuMusic{};
+        // Capture and append of the last journal record, in microseconds.
+        float mLastJournalAppendTime{};
+
+        AutosaveJournal mJournal{"Saves/auto_save.oejournal", "Saves/auto_save.oesave"};
+        RollbackBuffer mRollback{};
+        SaveHeaderCache mSaveHeaders{};
+        TextSearchIndex mSearchIndex{};
+        Atom mCurrentLabel{};
+        uint32_t mCurrentLabelIterator{UINT32_MAX};
+        FrameArena mFrameArena{};
+        ScriptAnalysis mScriptAnalysis{};
+        SaveHeader mPendingSaveHeader{};
+        std::vector<std::filesystem::path> mSaves{};
+        // Save and journal checkpoint writes; completions touch mSaveHeaders and mJournal, so it is declared after them.
+        WorkerThread mIoWorker{"IO"};
+        ScriptWatcher mScriptWatcher{{"Assets/Scripts/resources.lua", "Assets/Scripts/config.lua", "Assets/Scripts/utils.lua",
+                                      "Assets/Scripts/main.lua"}};
+
+        struct HotReloadInfo
+        {
+            uint32_t prevIterator{};
+            uint32_t iterator{};
+            float time{};
+        } mLastHotReload{};
 
         float mAutoSkipTotalTime{};
         uint32_t mCurrentParticlePos{};
         uint32_t mSelectedSave{};
+        uint32_t mNextSaveSlot{};
+        uint32_t mReplayTarget{};
+        uint32_t mReplayStalledSteps{};
+        char mHistoryQuery[128]{};
+        char mScriptQuery[128]{};
 
         bool mIsStart{true};
         bool mShowDebugInfoMenu{};
@@ -139,5 +217,9 @@ namespace TSOCA
         bool mShowSavesMenu{};
         bool mShowAcceptPopupModal{};
         bool mAutoNextStep{};
+        bool mIsSavesDirty{true};
+        bool mCanContinue{};
+        bool mIsReplaying{};
+        bool mIsHotReloadEnabled{};
     };
 } // namespace TSOCA
\ No newline at end of file
@@ -0,0 +1,210 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "TextSearchIndex.hpp"
+#include "Oneiro/VisualNovel/VNCore.hpp"
+#include "TextUtils.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace TSOCA
+{
+    namespace
+    {
+        // Returns the code point at `i` and advances past it; malformed bytes decode as themselves.
+        char32_t DecodeUtf8(std::string_view text, size_t& i)
+        {
+            const auto lead = static_cast<uint8_t>(text[i++]);
+            const uint32_t length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+            if (!length || i + length > text.size())
+                return lead;
+            char32_t codePoint = lead & (0x3F >> length);
+            for (uint32_t n{}; n < length; ++n)
+                codePoint = (codePoint << 6) | (static_cast<uint8_t>(text[i++]) & 0x3F);
+            return codePoint;
+        }
+
+        void AppendUtf8(char32_t codePoint, std::string& out)
+        {
+            if (codePoint < 0x80)
+                out += static_cast<char>(codePoint);
+            else if (codePoint < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (codePoint >> 6));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xE0 | (codePoint >> 12));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+        enum CaseFold : uint8_t
+        {
+            LOWER_CASE,
+            // Capital letter at a fixed offset from its small letter.
+            OFFSET_CASE,
+            // Capital on the even code point, small on the next odd one.
+            EVEN_PAIR_CASE,
+            // Capital on the odd code point, small on the next even one.
+            ODD_PAIR_CASE,
+        };
+
+        struct FoldRange
+        {
+            char32_t first{};
+            char32_t last{};
+            CaseFold fold{};
+            char32_t offset{};
+        };
+
+        // Sorted, non-overlapping word-character ranges; anything outside them separates words.
+        constexpr FoldRange FOLD_RANGES[]{
+            {'0', '9', LOWER_CASE},
+            {'A', 'Z', OFFSET_CASE, 0x20},
+            {'a', 'z', LOWER_CASE},
+            {0x0400, 0x040F, OFFSET_CASE, 0x50},
+            {0x0410, 0x042F, OFFSET_CASE, 0x20},
+            {0x0430, 0x045F, LOWER_CASE},
+            {0x0460, 0x0481, EVEN_PAIR_CASE},
+            // U+0482 is the thousands sign, U+0483-U+0489 are combining marks.
+            {0x048A, 0x04BF, EVEN_PAIR_CASE},
+            {0x04C0, 0x04C0, OFFSET_CASE, 0x0F}, // Palochka
+            {0x04C1, 0x04CE, ODD_PAIR_CASE},
+            {0x04CF, 0x04CF, LOWER_CASE},
+            {0x04D0, 0x052F, EVEN_PAIR_CASE},
+        };
+
+        bool IsCombiningMark(char32_t ch)
+        {
+            return (ch >= 0x0300 && ch <= 0x036F) || (ch >= 0x0483 && ch <= 0x0489);
+        }
+
+        // Lowercase form of a word character, or 0 for separators.
+        char32_t FoldWordChar(char32_t ch)
+        {
+            if (ch == 0x0401 || ch == 0x0451) // Ё ё
+                return 0x0435;
+            const auto it = std::upper_bound(std::begin(FOLD_RANGES), std::end(FOLD_RANGES), ch,
+                                             [](char32_t value, const FoldRange& range) { return value < range.first; });
+            if (it == std::begin(FOLD_RANGES) || ch > std::prev(it)->last)
+                return 0;
+            const auto& range = *std::prev(it);
+            switch (range.fold)
+            {
+            case OFFSET_CASE: return ch + range.offset;
+            case EVEN_PAIR_CASE: return ch | 1;
+            case ODD_PAIR_CASE: return ch + (ch & 1);
+            default: return ch;
+            }
+        }
+
+        std::vector<uint32_t> Intersect(const std::vector<uint32_t>& lhs, const std::vector<uint32_t>& rhs)
+        {
+            std::vector<uint32_t> result{};
+            std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(result));
+            return result;
+        }
+    } // namespace
+
+    std::vector<std::string> TokenizeText(std::string_view text)
+    {
+        std::vector<std::string> words{};
+        std::string word{};
+        for (size_t i{}; i < text.size();)
+        {
+            const auto codePoint = DecodeUtf8(text, i);
+            // Accents and titlos are dropped so marked and unmarked spellings match.
+            if (IsCombiningMark(codePoint))
+                continue;
+            if (const auto ch = FoldWordChar(codePoint))
+                AppendUtf8(ch, word);
+            else if (!word.empty())
+            {
+                words.push_back(std::move(word));
+                word.clear();
+            }
+        }
+        if (!word.empty())
+            words.push_back(std::move(word));
+        return words;
+    }
+
+    void TextSearchIndex::Update(uint32_t maxInstructions)
+    {
+        const auto& instructions = oe::VisualNovel::GetInstructions();
+        if (instructions.size() < mIndexedCount)
+            Clear();
+
+        const auto end = static_cast<uint32_t>(std::min<size_t>(instructions.size(), mIndexedCount + static_cast<size_t>(maxInstructions)));
+        for (; mIndexedCount < end; ++mIndexedCount)
+        {
+            const auto& instruction = instructions[mIndexedCount];
+            if (!instruction.EqualType(oe::VisualNovel::SAY_TEXT))
+                continue;
+            // Only the line is indexed, not the speaker's name.
+            for (auto& word : TokenizeText(StripMarkup(instruction.characterData.text)))
+            {
+                // Instructions are indexed in order, so postings stay sorted by construction.
+                auto& postings = mPostings[std::move(word)];
+                if (postings.empty() || postings.back() != mIndexedCount)
+                    postings.push_back(mIndexedCount);
+            }
+        }
+    }
+
+    void TextSearchIndex::Clear()
+    {
+        mPostings.clear();
+        mIndexedCount = 0;
+    }
+
+    std::vector<uint32_t> TextSearchIndex::Search(std::string_view query, uint32_t endIterator) const
+    {
+        const auto words = TokenizeText(query);
+        if (words.empty())
+            return {};
+
+        std::vector<uint32_t> result{};
+        for (size_t i{}; i < words.size(); ++i)
+        {
+            std::vector<uint32_t> matches{};
+            if (i + 1 < words.size())
+            {
+                const auto it = mPostings.find(words[i]);
+                if (it != mPostings.end())
+                    matches = it->second;
+            }
+            else
+            {
+                for (auto it = mPostings.lower_bound(words[i]); it != mPostings.end() && it->first.starts_with(words[i]); ++it)
+                {
+                    std::vector<uint32_t> merged{};
+                    std::set_union(matches.begin(), matches.end(), it->second.begin(), it->second.end(), std::back_inserter(merged));
+                    matches.swap(merged);
+                }
+            }
+
+            result = i ? Intersect(result, matches) : std::move(matches);
+            if (result.empty())
+                return {};
+        }
+
+        result.erase(std::lower_bound(result.begin(), result.end(), endIterator), result.end());
+        return result;
+    }
+
+    bool TextSearchIndex::IsComplete() const
+    {
+        return mIndexedCount == oe::VisualNovel::GetInstructions().size();
+    }
+
+    size_t TextSearchIndex::GetWordsCount() const
+    {
+        return mPostings.size();
+    }
+} // namespace TSOCA
@@ -0,0 +1,40 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace TSOCA
+{
+    // Splits UTF-8 text into lowercase words; Latin and Cyrillic letters and digits form words, "ё" folds to "е".
+    std::vector<std::string> TokenizeText(std::string_view text);
+
+    // Inverted index from words of the say text to instruction indices, filled a slice per frame.
+    class TextSearchIndex
+    {
+      public:
+        // Indexes up to `maxInstructions` more of the engine's instructions.
+        void Update(uint32_t maxInstructions = 512);
+        // Call when the script changes.
+        void Clear();
+
+        // Sorted indices of say instructions below `endIterator` containing every query word; the last
+        // word also matches as a prefix, so results follow the player's typing.
+        [[nodiscard]] std::vector<uint32_t> Search(std::string_view query, uint32_t endIterator = UINT32_MAX) const;
+
+        [[nodiscard]] bool IsComplete() const;
+        [[nodiscard]] size_t GetWordsCount() const;
+
+      private:
+        // Ordered, so prefix lookups are a lower_bound walk.
+        std::map<std::string, std::vector<uint32_t>, std::less<>> mPostings{};
+        uint32_t mIndexedCount{};
+    };
+} // namespace TSOCA
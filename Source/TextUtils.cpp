@@ -0,0 +1,33 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "TextUtils.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace TSOCA
+{
+    std::string StripMarkup(std::string_view text)
+    {
+        std::string result{};
+        result.reserve(text.size());
+        AppendStrippedMarkup(text, result);
+        return result;
+    }
+
+    void CopyUtf8Truncated(std::string_view text, char* dst, size_t dstSize)
+    {
+        if (dstSize == 0)
+            return;
+        size_t size = std::min(text.size(), dstSize - 1);
+        if (size < text.size())
+        {
+            while (size > 0 && (static_cast<unsigned char>(text[size]) & 0xC0) == 0x80)
+                --size;
+        }
+        std::memcpy(dst, text.data(), size);
+        std::memset(dst + size, 0, dstSize - size);
+    }
+} // namespace TSOCA
@@ -0,0 +1,67 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace TSOCA
+{
+    // Removes text commands like "[/i]" or "[/b]" while keeping other brackets.
+    std::string StripMarkup(std::string_view text);
+
+    template <typename String>
+    void AppendStrippedMarkup(std::string_view text, String& out)
+    {
+        bool checkForParseCmd{};
+        bool parseCmd{};
+
+        for (const char ch : text)
+        {
+            if (checkForParseCmd)
+            {
+                checkForParseCmd = false;
+                if (ch == '/')
+                {
+                    parseCmd = true;
+                    continue;
+                }
+                out += '[';
+            }
+
+            if (parseCmd)
+            {
+                if (ch == ']')
+                    parseCmd = false;
+                continue;
+            }
+
+            if (ch == '[')
+            {
+                checkForParseCmd = true;
+                continue;
+            }
+
+            out += ch;
+        }
+    }
+
+    // Copies text into a fixed buffer without splitting a UTF-8 sequence.
+    void CopyUtf8Truncated(std::string_view text, char* dst, size_t dstSize);
+
+    // FNV-1a, stable across runs and platforms so it can be stored in files.
+    constexpr uint32_t HashString(std::string_view text)
+    {
+        uint32_t hash{2166136261u};
+        for (const char ch : text)
+        {
+            hash ^= static_cast<uint8_t>(ch);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+} // namespace TSOCA
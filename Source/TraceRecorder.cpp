@@ -0,0 +1,193 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "TraceRecorder.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace TSOCA
+{
+    namespace
+    {
+        struct TraceEvent
+        {
+            const char* name{};
+            const char* category{};
+            int64_t begin{};
+            int64_t duration{};
+            uint32_t thread{};
+            std::string detail{};
+        };
+
+        struct TraceState
+        {
+            std::mutex mutex{};
+            std::vector<TraceEvent> events{};
+            std::vector<std::pair<uint32_t, std::string>> threadNames{};
+            std::filesystem::path output{};
+            std::chrono::steady_clock::time_point origin{};
+            std::atomic<bool> isRecording{};
+            std::atomic<uint32_t> nextThread{};
+        };
+
+        TraceState& GetState()
+        {
+            static TraceState state{};
+            return state;
+        }
+
+        uint32_t GetThreadLane()
+        {
+            thread_local const uint32_t lane = GetState().nextThread.fetch_add(1) + 1;
+            return lane;
+        }
+
+        void WriteEscaped(std::ofstream& file, std::string_view text)
+        {
+            for (const char ch : text)
+            {
+                switch (ch)
+                {
+                case '"': file << "\\\""; break;
+                case '\\': file << "\\\\"; break;
+                case '\n': file << "\\n"; break;
+                case '\r': file << "\\r"; break;
+                case '\t': file << "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(ch) < 0x20)
+                    {
+                        char escaped[8]{};
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                        file << escaped;
+                    }
+                    else
+                        file << ch;
+                }
+            }
+        }
+    } // namespace
+
+    namespace TraceRecorder
+    {
+        void Start(const std::filesystem::path& output)
+        {
+            auto& state = GetState();
+            std::lock_guard lock{state.mutex};
+            state.events.clear();
+            state.events.reserve(64 * 1024);
+            state.output = output;
+            state.origin = std::chrono::steady_clock::now();
+            state.isRecording = true;
+        }
+
+        bool Stop()
+        {
+            auto& state = GetState();
+            std::lock_guard lock{state.mutex};
+            if (!state.isRecording)
+                return false;
+            state.isRecording = false;
+
+            std::ofstream file{state.output};
+            if (!file.is_open())
+                return false;
+
+            file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            bool isFirst{true};
+            const auto separator = [&]() {
+                if (!isFirst)
+                    file << ",\n";
+                isFirst = false;
+            };
+            for (const auto& [thread, name] : state.threadNames)
+            {
+                separator();
+                file << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << thread << R"(,"args":{"name":")";
+                WriteEscaped(file, name);
+                file << "\"}}";
+            }
+            for (const auto& event : state.events)
+            {
+                separator();
+                file << R"({"name":")";
+                WriteEscaped(file, event.name);
+                file << R"(","cat":")" << event.category << R"(","ph":"X","pid":1,"tid":)" << event.thread << ",\"ts\":" << event.begin
+                     << ",\"dur\":" << event.duration;
+                if (!event.detail.empty())
+                {
+                    file << R"(,"args":{"detail":")";
+                    WriteEscaped(file, event.detail);
+                    file << "\"}";
+                }
+                file << '}';
+            }
+            file << "]}\n";
+            state.events.clear();
+            state.events.shrink_to_fit();
+            return file.good();
+        }
+
+        bool IsRecording()
+        {
+            return GetState().isRecording.load(std::memory_order_relaxed);
+        }
+
+        size_t GetEventsCount()
+        {
+            auto& state = GetState();
+            std::lock_guard lock{state.mutex};
+            return state.events.size();
+        }
+
+        void SetThreadName(std::string_view name)
+        {
+            auto& state = GetState();
+            const auto lane = GetThreadLane();
+            std::lock_guard lock{state.mutex};
+            for (auto& [thread, threadName] : state.threadNames)
+            {
+                if (thread == lane)
+                {
+                    threadName = name;
+                    return;
+                }
+            }
+            state.threadNames.emplace_back(lane, name);
+        }
+
+        void AddEvent(const char* name, const char* category, std::chrono::steady_clock::time_point begin,
+                      std::chrono::steady_clock::time_point end, std::string_view detail)
+        {
+            if (!IsRecording())
+                return;
+            auto& state = GetState();
+            const auto lane = GetThreadLane();
+            std::lock_guard lock{state.mutex};
+            if (!state.isRecording)
+                return;
+            using namespace std::chrono;
+            state.events.push_back({name, category, duration_cast<microseconds>(begin - state.origin).count(),
+                                    duration_cast<microseconds>(end - begin).count(), lane, std::string(detail)});
+        }
+    } // namespace TraceRecorder
+
+    TraceScope::TraceScope(const char* name, const char* category, std::string_view detail)
+        : mName(name), mCategory(category), mIsRecording(TraceRecorder::IsRecording())
+    {
+        if (!mIsRecording)
+            return;
+        mDetail = detail;
+        mBegin = std::chrono::steady_clock::now();
+    }
+
+    TraceScope::~TraceScope()
+    {
+        if (mIsRecording)
+            TraceRecorder::AddEvent(mName, mCategory, mBegin, std::chrono::steady_clock::now(), mDetail);
+    }
+} // namespace TSOCA
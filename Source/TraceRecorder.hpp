@@ -0,0 +1,47 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace TSOCA
+{
+    // Records complete events in the Chrome trace event format; open the file in chrome://tracing or ui.perfetto.dev.
+    // Every thread that records gets its own lane.
+    namespace TraceRecorder
+    {
+        void Start(const std::filesystem::path& output);
+        // Writes the file and stops recording.
+        bool Stop();
+        [[nodiscard]] bool IsRecording();
+        [[nodiscard]] size_t GetEventsCount();
+
+        void SetThreadName(std::string_view name);
+        // Name and category must outlive the recording, e.g. string literals.
+        void AddEvent(const char* name, const char* category, std::chrono::steady_clock::time_point begin,
+                      std::chrono::steady_clock::time_point end, std::string_view detail = {});
+    } // namespace TraceRecorder
+
+    class TraceScope
+    {
+      public:
+        explicit TraceScope(const char* name, const char* category = "Game", std::string_view detail = {});
+        ~TraceScope();
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+      private:
+        std::chrono::steady_clock::time_point mBegin{};
+        std::string mDetail{};
+        const char* mName{};
+        const char* mCategory{};
+        bool mIsRecording{};
+    };
+} // namespace TSOCA
@@ -0,0 +1,86 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "WorkerThread.hpp"
+#include "TraceRecorder.hpp"
+
+namespace TSOCA
+{
+    WorkerThread::WorkerThread(std::string name) : mName{std::move(name)}, mThread{&WorkerThread::Run, this}
+    {
+    }
+
+    WorkerThread::~WorkerThread()
+    {
+        {
+            std::lock_guard lock{mMutex};
+            mIsStopping = true;
+        }
+        mJobCondition.notify_one();
+        // Queued jobs still run, so pending writes are not lost; their completions are dropped.
+        mThread.join();
+    }
+
+    void WorkerThread::Submit(Job job, Job onComplete)
+    {
+        {
+            std::lock_guard lock{mMutex};
+            mJobs.emplace_back(std::move(job), std::move(onComplete));
+            ++mPendingCount;
+        }
+        mJobCondition.notify_one();
+    }
+
+    void WorkerThread::Poll()
+    {
+        std::vector<Job> completed{};
+        {
+            std::lock_guard lock{mMutex};
+            if (mCompleted.empty())
+                return;
+            completed.swap(mCompleted);
+        }
+        for (const auto& onComplete : completed)
+            onComplete();
+    }
+
+    void WorkerThread::Wait()
+    {
+        {
+            std::unique_lock lock{mMutex};
+            mIdleCondition.wait(lock, [this] { return mPendingCount == 0; });
+        }
+        Poll();
+    }
+
+    uint32_t WorkerThread::GetPendingCount() const
+    {
+        std::lock_guard lock{mMutex};
+        return mPendingCount;
+    }
+
+    void WorkerThread::Run()
+    {
+        TraceRecorder::SetThreadName(mName);
+        std::unique_lock lock{mMutex};
+        while (true)
+        {
+            mJobCondition.wait(lock, [this] { return mIsStopping || !mJobs.empty(); });
+            if (mJobs.empty())
+                return;
+
+            auto [job, onComplete] = std::move(mJobs.front());
+            mJobs.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+
+            if (onComplete)
+                mCompleted.push_back(std::move(onComplete));
+            if (--mPendingCount == 0)
+                mIdleCondition.notify_all();
+        }
+    }
+} // namespace TSOCA
@@ -0,0 +1,55 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace TSOCA
+{
+    // One background thread running jobs in submission order. Jobs get copies of whatever they need;
+    // their completions run on the thread calling Poll(), so they may touch game state.
+    class WorkerThread
+    {
+      public:
+        using Job = std::function<void()>;
+
+        explicit WorkerThread(std::string name);
+        ~WorkerThread();
+
+        WorkerThread(const WorkerThread&) = delete;
+        WorkerThread& operator=(const WorkerThread&) = delete;
+
+        void Submit(Job job, Job onComplete = {});
+        // Runs the completions of finished jobs.
+        void Poll();
+        // Blocks until every submitted job has finished, then runs their completions.
+        void Wait();
+
+        [[nodiscard]] uint32_t GetPendingCount() const;
+
+      private:
+        void Run();
+
+        std::string mName{};
+        mutable std::mutex mMutex{};
+        std::condition_variable mJobCondition{};
+        std::condition_variable mIdleCondition{};
+        std::deque<std::pair<Job, Job>> mJobs{};
+        std::vector<Job> mCompleted{};
+        uint32_t mPendingCount{};
+        bool mIsStopping{};
+        // Last, so the thread starts after everything it uses is constructed.
+        std::thread mThread{};
+    };
+} // namespace TSOCA